@@ -0,0 +1,97 @@
+#include <array>
+#include <filesystem>
+#include <thread>
+#include <core/assets/asset_server.hpp>
+#include "benches.hpp"
+
+namespace assets_bench_ns {
+
+    // Serves a flat folder of files from memory, so loading measures the `AssetServer` rather than the disk.
+    struct MemoryAssetIo final : AssetIo
+    {
+        std::vector<std::filesystem::path> files;
+        AssetBytes bytes = AssetBytes::from_vector(std::vector<std::byte>(256, std::byte{ 1 }));
+
+        explicit MemoryAssetIo(std::size_t const file_count)
+        {
+            for (std::size_t i = 0; i < file_count; ++i) {
+                files.emplace_back(fmt::format("{}.bench", i));
+            }
+        }
+
+        auto load_path(std::filesystem::path const&) const -> std::function<Result()> final
+        {
+            return [bytes = bytes]() -> Result { return bytes; };
+        }
+
+        auto root_path() const noexcept -> std::filesystem::path final { return "."; }
+
+        auto is_directory(std::filesystem::path const& path) const noexcept -> bool final
+        {
+            return path.empty() || path == ".";
+        }
+
+        auto read_directory(std::filesystem::path const&) const -> tl::expected<std::vector<std::filesystem::path>, std::error_code> final
+        {
+            return files;
+        }
+    };
+
+    struct BenchAsset
+    {
+        std::size_t size = 0;
+    };
+
+    struct BenchAssetLoader final : AssetLoader
+    {
+        static constexpr auto exts = std::array<std::string_view, 1>{ "bench" };
+
+        auto extensions() const noexcept -> std::span<std::string_view const> final { return exts; }
+
+        auto load(std::filesystem::path const&, std::span<std::byte const> bytes) const -> tl::optional<LoadedAsset> final
+        {
+            return LoadedAsset::create<BenchAsset>(bytes.size());
+        }
+    };
+
+} // namespace assets_bench_ns
+
+void assets_bench(BenchRunner& runner)
+{
+    using namespace assets_bench_ns;
+
+    auto const pool = TaskPool{};
+
+    {
+        constexpr std::size_t files = 1'000;
+        runner.run("AssetServer::load_folder/1000", files, [&] {
+            // a new server every iteration, already loaded paths would not be loaded again.
+            auto server = AssetServer(std::make_unique<MemoryAssetIo>(files), pool);
+            auto assets = server.register_asset_type<BenchAsset>();
+            server.add_asset_loader<BenchAssetLoader>();
+
+            auto const handles = server.load_folder(".");
+            for (auto const& handle : *handles) {
+                while (server.get_load_state(handle.id()) != LoadState::Loaded) {
+                    std::this_thread::yield();
+                }
+            }
+            do_not_optimize(handles->size());
+        });
+    }
+
+    {
+        constexpr std::size_t count = 10'000;
+        auto server = AssetServer(std::make_unique<MemoryAssetIo>(0), pool);
+        auto const handle = server.get_handle<BenchAsset>(HandleId::from_path("a.bench"));
+
+        // every copy and drop sends a ref count change, which the server drains once per frame.
+        runner.run("Handle::copy+drop/10000", count, [&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                auto copy = handle.copy();
+                do_not_optimize(copy.id());
+            }
+            server.update_asset_ref_count();
+        });
+    }
+}
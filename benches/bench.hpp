@@ -0,0 +1,153 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
+// Keeps the compiler from optimizing away a benchmarked value.
+template <typename T>
+inline void do_not_optimize(T const& value)
+{
+#ifdef _MSC_VER
+    auto const volatile sink = static_cast<void const*>(std::addressof(value));
+    static_cast<void>(sink);
+    _ReadWriteBarrier();
+#else
+    asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+struct BenchResult
+{
+    std::string name;
+    std::size_t iterations = 0; // per sample
+    std::size_t samples = 0;
+    std::size_t items = 0;      // items processed per iteration, e.g. entities or events
+    double mean_ns = 0.0;       // per iteration
+    double median_ns = 0.0;
+    double min_ns = 0.0;
+    double stddev_ns = 0.0;
+
+    [[nodiscard]] auto items_per_second() const noexcept -> double
+    {
+        return median_ns > 0.0 ? static_cast<double>(items) * 1e9 / median_ns : 0.0;
+    }
+};
+
+// Times a benchmark over a fixed amount of samples, after a warm up run.
+// Every sample runs enough iterations to take at least `min_sample_time`, so that the clock's resolution does not matter.
+class BenchRunner
+{
+    using clock_t = std::chrono::steady_clock;
+
+    std::vector<BenchResult> m_results;
+    std::string m_filter;
+    std::size_t m_samples;
+    clock_t::duration m_min_sample_time;
+
+    template <typename F>
+    static auto time_iterations(F& f, std::size_t const iterations) -> clock_t::duration
+    {
+        auto const start = clock_t::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            f();
+        }
+        return clock_t::now() - start;
+    }
+
+public:
+    explicit BenchRunner(std::string filter = {}, std::size_t const samples = 15, clock_t::duration const min_sample_time = std::chrono::milliseconds(10))
+        : m_filter(std::move(filter))
+        , m_samples(samples)
+        , m_min_sample_time(min_sample_time)
+    {}
+
+    // `f` runs a single iteration, which processes `items` items.
+    template <typename F>
+    void run(std::string_view const name, std::size_t const items, F&& f)
+    {
+        if (!m_filter.empty() && name.find(m_filter) == std::string_view::npos) {
+            return;
+        }
+
+        // warm up, and find how many iterations fill a sample.
+        std::size_t iterations = 1;
+        while (time_iterations(f, iterations) < m_min_sample_time && iterations < (std::size_t{ 1 } << 30)) {
+            iterations *= 2;
+        }
+
+        auto times = std::vector<double>{};
+        times.reserve(m_samples);
+        for (std::size_t s = 0; s < m_samples; ++s) {
+            auto const elapsed = std::chrono::duration<double, std::nano>(time_iterations(f, iterations));
+            times.push_back(elapsed.count() / static_cast<double>(iterations));
+        }
+
+        std::sort(times.begin(), times.end());
+        auto const n = static_cast<double>(times.size());
+        auto const mean = std::accumulate(times.begin(), times.end(), 0.0) / n;
+        auto const variance = std::accumulate(times.begin(), times.end(), 0.0, [mean](double const acc, double const t) {
+            return acc + (t - mean) * (t - mean);
+        }) / n;
+
+        auto const& result = m_results.emplace_back(BenchResult{
+            .name = std::string(name),
+            .iterations = iterations,
+            .samples = times.size(),
+            .items = items,
+            .mean_ns = mean,
+            .median_ns = times[times.size() / 2],
+            .min_ns = times.front(),
+            .stddev_ns = std::sqrt(variance),
+        });
+
+        fmt::print("{:<48} {:>14.1f} ns/iter  (+/- {:>10.1f})  {:>14.0f} items/s\n",
+            result.name, result.median_ns, result.stddev_ns, result.items_per_second());
+    }
+
+    [[nodiscard]] auto results() const noexcept -> std::vector<BenchResult> const& { return m_results; }
+
+    // {"benchmarks":[{"name":..., "median_ns":..., ...}]}, one entry per benchmark so runs can be diffed release to release.
+    [[nodiscard]] auto to_json() const -> std::string
+    {
+        auto out = std::string{ "{\"benchmarks\":[" };
+        bool first = true;
+        for (auto const& r : m_results) {
+            if (!first) {
+                out.push_back(',');
+            }
+            first = false;
+            fmt::format_to(std::back_inserter(out),
+                "{{\"name\":\"{}\",\"iterations\":{},\"samples\":{},\"items\":{},"
+                "\"mean_ns\":{:.3f},\"median_ns\":{:.3f},\"min_ns\":{:.3f},\"stddev_ns\":{:.3f},\"items_per_second\":{:.3f}}}",
+                r.name, r.iterations, r.samples, r.items, r.mean_ns, r.median_ns, r.min_ns, r.stddev_ns, r.items_per_second());
+        }
+        out += "]}";
+        return out;
+    }
+
+    auto write_json(std::string const& path) const -> bool
+    {
+        auto file = std::ofstream(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        auto const json = to_json();
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        return static_cast<bool>(file);
+    }
+};
@@ -0,0 +1,22 @@
+#include <string>
+#include <fmt/format.h>
+#include "benches.hpp"
+
+// usage: benches [output.json] [name filter]
+int main(int argc, char** argv)
+{
+    auto const output = argc > 1 ? std::string(argv[1]) : std::string("bench-results.json");
+    auto runner = BenchRunner(argc > 2 ? std::string(argv[2]) : std::string{});
+
+    ecs_bench(runner);
+    events_bench(runner);
+    assets_bench(runner);
+    render_bench(runner);
+
+    if (!runner.write_json(output)) {
+        fmt::print(stderr, "Unable to write benchmark results to: '{}'\n", output);
+        return 1;
+    }
+    fmt::print("Wrote {} benchmark results to: '{}'\n", runner.results().size(), output);
+    return 0;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+#include "bench.hpp"
+
+void assets_bench(BenchRunner& runner);
+void ecs_bench(BenchRunner& runner);
+void events_bench(BenchRunner& runner);
+void render_bench(BenchRunner& runner);
@@ -0,0 +1,72 @@
+#include <string>
+#include <core/ecs/query.hpp>
+#include <core/ecs/resource.hpp>
+#include <core/ecs/system.hpp>
+#include <core/ecs/world.hpp>
+#include "benches.hpp"
+
+namespace ecs_bench_ns {
+
+    struct Position { float x = 0.f, y = 0.f; };
+    struct Velocity { float x = 1.f, y = 1.f; };
+    struct Counter { std::size_t value = 0; };
+
+    void empty_system() {}
+
+    void resource_system(Resource<Counter> counter)
+    {
+        ++counter->value;
+    }
+
+    void query_system(Query<With<Position, Velocity const>> query)
+    {
+        query.each([](Position& pos, Velocity const& vel) {
+            pos.x += vel.x;
+            pos.y += vel.y;
+        });
+    }
+
+} // namespace ecs_bench_ns
+
+void ecs_bench(BenchRunner& runner)
+{
+    using namespace ecs_bench_ns;
+
+    // the cost of running a system, excluding its work.
+    {
+        auto resources = Resources{};
+        auto world = World{};
+        resources.set_resource<Counter>();
+
+        auto empty = System::create(empty_system);
+        empty.prepare(resources, world);
+        runner.run("System::run/no args", 1, [&] { empty.run(resources, world); });
+
+        auto with_resource = System::create(resource_system);
+        with_resource.prepare(resources, world);
+        runner.run("System::run/resource", 1, [&] { with_resource.run(resources, world); });
+    }
+
+    for (std::size_t const count : { 10'000u, 100'000u, 1'000'000u }) {
+        auto resources = Resources{};
+        auto world = World{};
+        for (std::size_t i = 0; i < count; ++i) {
+            auto const e = world.create();
+            world.emplace<Position>(e);
+            world.emplace<Velocity>(e);
+        }
+
+        using query_t = Query<With<Position, Velocity const>>;
+        auto query = query_t(query_t::create_repr(world));
+        runner.run(fmt::format("Query::each/{}", count), count, [&] {
+            query.each([](Position& pos, Velocity const& vel) {
+                pos.x += vel.x;
+                pos.y += vel.y;
+            });
+        });
+
+        auto system = System::create(query_system);
+        system.prepare(resources, world);
+        runner.run(fmt::format("System::run/query {}", count), count, [&] { system.run(resources, world); });
+    }
+}
@@ -0,0 +1,52 @@
+#include <core/game/events.hpp>
+#include "benches.hpp"
+
+namespace events_bench_ns {
+
+    struct Damage
+    {
+        std::uint32_t target = 0;
+        float amount = 0.f;
+    };
+
+} // namespace events_bench_ns
+
+void events_bench(BenchRunner& runner)
+{
+    using namespace events_bench_ns;
+
+    for (std::size_t const count : { 1'000u, 100'000u }) {
+        // a frame's worth of events: sent, and then swapped out by `update()`.
+        auto events = Events<Damage>{};
+        runner.run(fmt::format("Events::send/{}", count), count, [&] {
+            for (std::size_t i = 0; i < count; ++i) {
+                events.send(Damage{ .target = static_cast<std::uint32_t>(i), .amount = 1.f });
+            }
+            events.update();
+        });
+
+        auto filled = Events<Damage>{};
+        for (std::size_t i = 0; i < count; ++i) {
+            filled.send(Damage{ .target = static_cast<std::uint32_t>(i), .amount = 1.f });
+        }
+        runner.run(fmt::format("EventReader::iter/{}", count), count, [&] {
+            auto reader = ManualEventReader<Damage>();
+            float total = 0.f;
+            for (auto const& damage : reader.iter(filled)) {
+                total += damage.amount;
+            }
+            do_not_optimize(total);
+        });
+
+        runner.run(fmt::format("EventReader::for_each_batch/{}", count), count, [&] {
+            auto reader = ManualEventReader<Damage>();
+            float total = 0.f;
+            reader.for_each_batch(filled, [&total](std::span<Event<Damage> const> const batch) {
+                for (auto const& event : batch) {
+                    total += event.value.amount;
+                }
+            });
+            do_not_optimize(total);
+        });
+    }
+}
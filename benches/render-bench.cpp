@@ -0,0 +1,76 @@
+#include <vector>
+#include <SDL2/SDL.h>
+#include <core/assets/asset_server.hpp>
+#include <core/ecs/commands.hpp>
+#include <core/ecs/system.hpp>
+#include <core/render/render_context.hpp>
+#include <core/render/system.hpp>
+#include <core/render/texture.hpp>
+#include <core/sprite/sprite.hpp>
+#include <sdl/sdl.hpp>
+#include "benches.hpp"
+
+namespace render_bench_ns {
+
+    struct NullAssetIo final : AssetIo
+    {
+        auto load_path(std::filesystem::path const&) const -> std::function<Result()> final
+        {
+            return []() -> Result { return tl::make_unexpected(Error::NotFound); };
+        }
+
+        auto root_path() const noexcept -> std::filesystem::path final { return "."; }
+    };
+
+} // namespace render_bench_ns
+
+// `render_draw_system` drawing into a software renderer, so the benchmark runs without a window or a GPU.
+void render_bench(BenchRunner& runner)
+{
+    using namespace render_bench_ns;
+
+    auto surface = sdl::Surface::from_raw(SDL_CreateRGBSurfaceWithFormat(0, 1280, 720, 32, SDL_PIXELFORMAT_RGBA32));
+    if (!surface.raw()) {
+        fmt::print(stderr, "Skipping render benchmarks, unable to create a surface: {}\n", SDL_GetError());
+        return;
+    }
+    auto ctx = RenderContext::create_software(surface);
+    if (!ctx) {
+        fmt::print(stderr, "Skipping render benchmarks, unable to create a software renderer: {}\n", SDL_GetError());
+        return;
+    }
+
+    auto resources = Resources{};
+    auto world = World{};
+    auto const server = AssetServer(std::make_unique<NullAssetIo>(), TaskPool(1));
+
+    auto const texture = [&] {
+        auto sprite_surface = sdl::Surface::from_raw(SDL_CreateRGBSurfaceWithFormat(0, 32, 32, 32, SDL_PIXELFORMAT_RGBA32));
+        SDL_FillRect(sprite_surface.raw(), nullptr, SDL_MapRGBA(sprite_surface.raw()->format, 200, 100, 50, 255));
+        return SDL_CreateTextureFromSurface(ctx->raw(), sprite_surface.raw());
+    }();
+
+    auto textures = resources.set_resource<Assets<Texture>>(server.register_asset_type<Texture>());
+    auto const handle = textures->add_asset(texture);
+    resources.set_resource<RenderContext>(*MOV(ctx));
+
+    for (std::size_t const count : { 1'000u, 10'000u }) {
+        world.clear();
+
+        auto sprites = std::vector<SpriteBundle>{};
+        sprites.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            sprites.push_back(SpriteBundle{
+                .sprite = Sprite{ .size = Vec2(32.f, 32.f) },
+                .transform = Transform{ .translation = Vec2(static_cast<float>(i * 37 % 1248), static_cast<float>(i * 53 % 688)) },
+                .texture = handle.copy_weak(),
+                .color = i % 4 == 0 ? tl::optional<Color>(Color{ 255, 0, 0, 128 }) : tl::nullopt,
+            });
+        }
+        spawn_batch(world, std::span<SpriteBundle>(sprites));
+
+        auto system = System::create(render_draw_system);
+        system.prepare(resources, world);
+        runner.run(fmt::format("render_draw_system/software {}", count), count, [&] { system.run(resources, world); });
+    }
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include "asset_io/asset_bytes.hpp"
+#include "asset_io/mapped_file.hpp"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tl/expected.hpp>
+#include <tl/optional.hpp>
+#include <util/common.hpp>
+
+// Layout of a cache entry, one file per source asset named after its content hash:
+//
+//   Header
+//   padding               up to `payload_alignment`
+//   std::byte[payload_size]   whatever the loader's `write_cache` produced
+//
+// An entry only hits if the source is byte for byte the same size and hash, and the loader still writes the same version.
+namespace asset_cache {
+
+    inline constexpr auto magic = std::array<char, 8>{ 'C', 'N', 'G', 'C', 'A', 'C', 'H', 'E' };
+    inline constexpr std::uint32_t version = 1;
+    inline constexpr std::uint64_t payload_alignment = 16;
+
+    struct Header
+    {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t loader_version;
+        std::uint64_t source_hash;
+        std::uint64_t source_size;
+        std::uint64_t payload_size;
+    };
+
+    static_assert(sizeof(Header) == 40 && std::is_trivially_copyable_v<Header>);
+
+    inline constexpr std::uint64_t payload_offset = (sizeof(Header) + payload_alignment - 1) / payload_alignment * payload_alignment;
+
+    namespace _detail {
+
+        inline constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87;
+        inline constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4F;
+        inline constexpr std::uint64_t prime3 = 0x165667B19E3779F9;
+        inline constexpr std::uint64_t prime4 = 0x85EBCA77C2B2AE63;
+        inline constexpr std::uint64_t prime5 = 0x27D4EB2F165667C5;
+
+        [[nodiscard]] inline auto read64(std::byte const* const ptr) noexcept -> std::uint64_t
+        {
+            auto value = std::uint64_t{};
+            std::memcpy(&value, ptr, sizeof(value));
+            return value;
+        }
+
+        [[nodiscard]] inline auto read32(std::byte const* const ptr) noexcept -> std::uint64_t
+        {
+            auto value = std::uint32_t{};
+            std::memcpy(&value, ptr, sizeof(value));
+            return value;
+        }
+
+        [[nodiscard]] constexpr auto round(std::uint64_t acc, std::uint64_t const input) noexcept -> std::uint64_t
+        {
+            acc += input * prime2;
+            acc = std::rotl(acc, 31);
+            return acc * prime1;
+        }
+
+        [[nodiscard]] constexpr auto merge_round(std::uint64_t acc, std::uint64_t const value) noexcept -> std::uint64_t
+        {
+            acc ^= round(0, value);
+            return acc * prime1 + prime4;
+        }
+
+    } // namespace _detail
+
+    // XXH64 of `bytes` (as read on a little endian machine). Unlike FNV-1a it consumes 32 bytes per step,
+    // so hashing a source is far cheaper than decoding it.
+    [[nodiscard]] inline auto content_hash(std::span<std::byte const> const bytes, std::uint64_t const seed = 0) noexcept -> std::uint64_t
+    {
+        using namespace _detail;
+
+        auto const* ptr = bytes.data();
+        auto const* const end = ptr + bytes.size();
+        auto hash = std::uint64_t{};
+
+        if (bytes.size() >= 32) {
+            auto v1 = seed + prime1 + prime2;
+            auto v2 = seed + prime2;
+            auto v3 = seed;
+            auto v4 = seed - prime1;
+
+            for (; end - ptr >= 32; ptr += 32) {
+                v1 = round(v1, read64(ptr));
+                v2 = round(v2, read64(ptr + 8));
+                v3 = round(v3, read64(ptr + 16));
+                v4 = round(v4, read64(ptr + 24));
+            }
+
+            hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+            hash = merge_round(hash, v1);
+            hash = merge_round(hash, v2);
+            hash = merge_round(hash, v3);
+            hash = merge_round(hash, v4);
+        }
+        else {
+            hash = seed + prime5;
+        }
+
+        hash += static_cast<std::uint64_t>(bytes.size());
+
+        for (; end - ptr >= 8; ptr += 8) {
+            hash ^= round(0, read64(ptr));
+            hash = std::rotl(hash, 27) * prime1 + prime4;
+        }
+        if (end - ptr >= 4) {
+            hash ^= read32(ptr) * prime1;
+            hash = std::rotl(hash, 23) * prime2 + prime3;
+            ptr += 4;
+        }
+        for (; ptr != end; ++ptr) {
+            hash ^= static_cast<std::uint64_t>(*ptr) * prime5;
+            hash = std::rotl(hash, 11) * prime1;
+        }
+
+        hash ^= hash >> 33;
+        hash *= prime2;
+        hash ^= hash >> 29;
+        hash *= prime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+
+    // identifies the cache entry of a source asset.
+    struct Key
+    {
+        std::uint64_t source_hash;
+        std::uint64_t source_size;
+        std::uint32_t loader_version;
+        // tells apart the entries of different loaders for the same bytes, e.g. the extension the loader was picked by.
+        std::string_view tag;
+
+        [[nodiscard]] static auto from_source(std::span<std::byte const> const source, std::string_view const tag, std::uint32_t const loader_version) noexcept -> Key
+        {
+            return Key{
+                .source_hash = content_hash(source),
+                .source_size = source.size(),
+                .loader_version = loader_version,
+                .tag = tag,
+            };
+        }
+    };
+
+} // namespace asset_cache
+
+// An on-disk cache of decoded assets, keyed by the content of their source file. Loaders that opt in
+// (see `AssetLoader::cache_version`) are skipped on a hit, so unchanged assets are not decoded again on the next launch.
+// Entries are written to a temporary file first and renamed into place, so concurrent loads never observe a partial entry.
+class AssetCache
+{
+    std::filesystem::path m_folder;
+
+    explicit AssetCache(std::filesystem::path folder) noexcept
+        : m_folder(MOV(folder))
+    {}
+
+    [[nodiscard]] auto entry_path(asset_cache::Key const& key) const -> std::filesystem::path
+    {
+        return m_folder / fmt::format("{:016x}.{}", key.source_hash, key.tag);
+    }
+
+public:
+    // creates `folder` if it does not exist yet.
+    [[nodiscard]] static auto create(std::filesystem::path folder) -> tl::expected<AssetCache, std::error_code>
+    {
+        auto ec = std::error_code{};
+        std::filesystem::create_directories(folder, ec);
+        if (ec) {
+            return tl::make_unexpected(ec);
+        }
+        return AssetCache(MOV(folder));
+    }
+
+    [[nodiscard]] auto folder() const noexcept -> std::filesystem::path const&
+    {
+        return m_folder;
+    }
+
+    // the payload stored for `key`, as a view into the mapped entry.
+    [[nodiscard]] auto find(asset_cache::Key const& key) const -> tl::optional<AssetBytes>
+    {
+        auto mapped = MappedFile::open(entry_path(key));
+        if (!mapped) {
+            return tl::nullopt;
+        }
+        auto file = std::make_shared<MappedFile const>(*MOV(mapped));
+        auto const bytes = file->bytes();
+
+        auto header = asset_cache::Header{};
+        if (bytes.size() < asset_cache::payload_offset) {
+            return tl::nullopt;
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        bool const valid = header.magic == asset_cache::magic
+            && header.version == asset_cache::version
+            && header.loader_version == key.loader_version
+            && header.source_hash == key.source_hash
+            && header.source_size == key.source_size
+            && header.payload_size == bytes.size() - asset_cache::payload_offset;
+        if (!valid) {
+            return tl::nullopt;
+        }
+
+        return AssetBytes(file, bytes.subspan(asset_cache::payload_offset));
+    }
+
+    // (over)writes the entry of `key`, returns false if it could not be written.
+    auto store(asset_cache::Key const& key, std::span<std::byte const> const payload) const -> bool
+    {
+        auto const header = asset_cache::Header{
+            .magic = asset_cache::magic,
+            .version = asset_cache::version,
+            .loader_version = key.loader_version,
+            .source_hash = key.source_hash,
+            .source_size = key.source_size,
+            .payload_size = payload.size(),
+        };
+        static constexpr auto padding = std::array<char, asset_cache::payload_offset - sizeof(asset_cache::Header)>{};
+
+        auto const path = entry_path(key);
+        auto temp_path = path;
+        temp_path += fmt::format(".{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        {
+            auto out = std::ofstream(temp_path, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            out.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+            out.write(reinterpret_cast<char const*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+            out.flush();
+            if (!out) {
+                out.close();
+                auto ec = std::error_code{};
+                std::filesystem::remove(temp_path, ec);
+                return false;
+            }
+        }
+
+        auto ec = std::error_code{};
+        std::filesystem::rename(temp_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+            return false;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include <util/common.hpp>
+
+// Read-only view of an asset file's bytes that shares ownership of whatever backs them (a mapped file, a heap buffer, ...).
+// Copies are cheap and the bytes stay valid for as long as any copy is alive.
+class AssetBytes
+{
+    std::shared_ptr<void const> m_owner;
+    std::span<std::byte const> m_bytes;
+
+public:
+    AssetBytes() noexcept = default;
+
+    // `bytes` must stay valid for as long as `owner` is alive.
+    AssetBytes(std::shared_ptr<void const> owner, std::span<std::byte const> const bytes) noexcept
+        : m_owner(MOV(owner))
+        , m_bytes(bytes)
+    {}
+
+    [[nodiscard]] static auto from_vector(std::vector<std::byte> bytes) -> AssetBytes
+    {
+        auto owner = std::make_shared<std::vector<std::byte> const>(MOV(bytes));
+        auto const view = std::span<std::byte const>(*owner);
+        return AssetBytes(MOV(owner), view);
+    }
+
+    [[nodiscard]] auto data() const noexcept -> std::byte const* { return m_bytes.data(); }
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return m_bytes.size(); }
+    [[nodiscard]] auto empty() const noexcept -> bool { return m_bytes.empty(); }
+
+    [[nodiscard]] auto begin() const noexcept { return m_bytes.begin(); }
+    [[nodiscard]] auto end() const noexcept { return m_bytes.end(); }
+
+    [[nodiscard]] auto span() const noexcept -> std::span<std::byte const> { return m_bytes; }
+    operator std::span<std::byte const>() const noexcept { return m_bytes; }
+};
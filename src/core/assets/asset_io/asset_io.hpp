@@ -1,5 +1,6 @@
 #pragma once
 
+#include "asset_bytes.hpp"
 #include <cstddef>
 #include <filesystem>
 #include <functional>
@@ -16,27 +17,47 @@ struct AssetIo
         IoError,
     };
 
-    using Result = tl::expected<std::vector<std::byte>, Error>;
+    using Result = tl::expected<AssetBytes, Error>;
+
+    virtual ~AssetIo() = default;
 
     // TODO: This should probably return a std::function<Result(std::string_view)>
     //       Or maybe a boost::future??
     virtual auto load_path(std::filesystem::path const& path) const -> std::function<Result()> = 0;
     virtual auto root_path() const noexcept -> std::filesystem::path = 0;
 
+    // `path` is relative to `root_path()`.
     virtual auto is_directory(std::filesystem::path const& path) const noexcept -> bool 
     {
         std::error_code ec{};
-        return std::filesystem::is_directory(path, ec);
+        return std::filesystem::is_directory(root_path() / path, ec);
     }
 
-    virtual auto read_directory(std::filesystem::path const& dir) const noexcept -> tl::expected<std::filesystem::directory_iterator, std::error_code>
+    // the files and directories directly inside `dir`, both `dir` and the returned paths are relative to `root_path()`.
+    // the returned paths are normalized, so `read_directory(".")` yields `x.png` rather than `./x.png`.
+    virtual auto read_directory(std::filesystem::path const& dir) const -> tl::expected<std::vector<std::filesystem::path>, std::error_code>
     {
         std::error_code ec{};
-        auto dir_iter = std::filesystem::directory_iterator(root_path() / dir, ec);
+        auto paths = std::vector<std::filesystem::path>{};
+        for (auto iter = std::filesystem::directory_iterator(root_path() / dir, ec); !ec && iter != std::filesystem::directory_iterator(); iter.increment(ec)) {
+            paths.push_back((dir / iter->path().filename()).lexically_normal());
+        }
         if (ec != std::error_code{}) {
             return tl::make_unexpected(ec);
         }
-        return dir_iter;
+        return paths;
+    }
+
+    // starts tracking changes to the files below `root_path()`, returns false if they can not be watched.
+    virtual auto watch_for_changes() -> bool
+    {
+        return false;
+    }
+
+    // the files (relative to `root_path()`) that changed since the last call, empty unless `watch_for_changes()` succeeded.
+    virtual auto changed_paths() -> std::vector<std::filesystem::path>
+    {
+        return {};
     }
 };
 
@@ -1,45 +1,147 @@
 #pragma once
 
 #include "asset_io.hpp"
+#include "asset_pack.hpp"
+#include "file_watcher.hpp"
+#include "mapped_file.hpp"
+#include <atomic>
 #include <cstdio>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <util/common.hpp>
 
 
 class FileAssetIo final : public AssetIo
 {
     std::filesystem::path m_root_path;
+    tl::optional<FileWatcher> m_watcher = tl::nullopt;
+    // set once watching, see `load_path`.
+    std::atomic<bool> m_read_files{ false };
+
+    static auto read_file(std::filesystem::path const& path) -> Result
+    {
+        auto const file = std::fopen(path.string().c_str(), "rb");
+        if (file == nullptr) {
+            return tl::make_unexpected(Error::IoError);
+        }
+
+        std::fseek(file, 0, SEEK_END);
+        auto const size = std::ftell(file);
+        std::rewind(file);
+        if (size < 0) {
+            std::fclose(file);
+            return tl::make_unexpected(Error::IoError);
+        }
+
+        // not value-initialized, every byte is overwritten by the read.
+        auto const count = static_cast<std::size_t>(size);
+        auto buffer = std::shared_ptr<std::byte[]>(std::make_unique_for_overwrite<std::byte[]>(count));
+
+        if (std::fread(buffer.get(), sizeof(std::byte), count, file) != count) {
+            std::fclose(file);
+            return tl::make_unexpected(Error::IoError);
+        }
+
+        std::fclose(file);
+        auto const bytes = std::span<std::byte const>(buffer.get(), count);
+        return AssetBytes(MOV(buffer), bytes);
+    }
     
 public:
     explicit FileAssetIo(std::string root_path)
         : m_root_path(MOV(root_path))
     {}
 
+    // the file is mapped rather than read, its bytes are only paged in as the loader touches them.
+    // watched files are read into memory instead: an editor may truncate or rewrite them at any time,
+    // and touching a mapping past the new end of its file raises SIGBUS.
     auto load_path(std::filesystem::path const& path) const -> std::function<Result()> final
     {
-        auto const full_path = m_root_path / path;
+        auto full_path = m_root_path / path;
+        if (m_read_files.load(std::memory_order_relaxed)) {
+            return [path = MOV(full_path)] () -> Result { return read_file(path); };
+        }
         return [path = MOV(full_path)] () -> Result {
-            auto const file = fopen(path.string().c_str(), "rb");
-            if (file == nullptr) {
-                return tl::make_unexpected(Error::IoError);
+            auto mapped = MappedFile::open(path);
+            if (mapped) {
+                auto owner = std::make_shared<MappedFile const>(*MOV(mapped));
+                auto const bytes = owner->bytes();
+                return AssetBytes(MOV(owner), bytes);
             }
 
-            std::fseek(file, 0, SEEK_END);
-            auto const size = std::ftell(file);
-            std::rewind(file);
+            // files that can not be mapped (e.g. pipes) are read instead.
+            return read_file(path);
+        };
+    }
 
-            auto buffer = std::vector<std::byte>(size, std::byte{});
+    auto root_path() const noexcept -> std::filesystem::path final { return m_root_path;  }
 
-            if (std::fread(buffer.data(), sizeof(std::byte), size, file) != size) {
-                std::fclose(file);
-                return tl::make_unexpected(Error::IoError);
+    auto watch_for_changes() -> bool final
+    {
+        if (!m_watcher.has_value()) {
+            auto watcher = FileWatcher::create(m_root_path);
+            if (!watcher) {
+                return false;
             }
+            m_watcher = *MOV(watcher);
+            m_read_files.store(true, std::memory_order_relaxed);
+        }
+        return true;
+    }
 
-            std::fclose(file);
-            return buffer;
+    auto changed_paths() -> std::vector<std::filesystem::path> final
+    {
+        if (!m_watcher.has_value()) {
+            return {};
+        }
+        return m_watcher->poll();
+    }
+};
+
+// Serves every asset out of a single memory-mapped pack, see `write_asset_pack`.
+class PackAssetIo final : public AssetIo
+{
+    std::filesystem::path m_pack_path;
+    std::shared_ptr<AssetPack const> m_pack;
+
+    PackAssetIo(std::filesystem::path pack_path, AssetPack&& pack)
+        : m_pack_path(MOV(pack_path))
+        , m_pack(std::make_shared<AssetPack const>(MOV(pack)))
+    {}
+
+public:
+    [[nodiscard]] static auto open(std::filesystem::path pack_path) -> tl::expected<PackAssetIo, std::error_code>
+    {
+        auto pack = AssetPack::open(pack_path);
+        if (!pack) {
+            return tl::make_unexpected(pack.error());
+        }
+        return PackAssetIo(MOV(pack_path), *MOV(pack));
+    }
+
+    auto load_path(std::filesystem::path const& path) const -> std::function<Result()> final
+    {
+        return [pack = m_pack, path] () -> Result {
+            if (auto bytes = pack->find(path); bytes) {
+                return *MOV(bytes);
+            }
+            return tl::make_unexpected(Error::NotFound);
         };
     }
 
-    auto root_path() const noexcept -> std::filesystem::path final { return m_root_path;  }
+    auto root_path() const noexcept -> std::filesystem::path final { return m_pack_path; }
+
+    auto is_directory(std::filesystem::path const& path) const noexcept -> bool final
+    {
+        return m_pack->is_directory(path);
+    }
 
-};
\ No newline at end of file
+    auto read_directory(std::filesystem::path const& dir) const -> tl::expected<std::vector<std::filesystem::path>, std::error_code> final
+    {
+        if (auto const children = m_pack->read_directory(dir); children) {
+            return *children;
+        }
+        return tl::make_unexpected(std::make_error_code(std::errc::not_a_directory));
+    }
+};
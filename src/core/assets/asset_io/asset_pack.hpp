@@ -0,0 +1,318 @@
+#pragma once
+
+#include "asset_bytes.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <tl/expected.hpp>
+#include <tl/optional.hpp>
+#include <util/common.hpp>
+#include <util/containers/hash.hpp>
+#include <vector>
+
+// Layout of an asset pack, a single file holding every asset of a folder:
+//
+//   Header
+//   Entry[entry_count]      sorted by (path_hash, path)
+//   char[strings_size]      the '/' separated paths of the entries, relative to the packed folder
+//   blobs                   the contents of the files, each aligned to `blob_alignment`
+//
+// Integers are stored in the byte order of the machine that wrote the pack, a pack from a machine with a
+// different byte order is rejected because its version does not match.
+namespace asset_pack {
+
+    inline constexpr auto magic = std::array<char, 8>{ 'C', 'N', 'G', 'P', 'A', 'C', 'K', '\0' };
+    inline constexpr std::uint32_t version = 1;
+    inline constexpr std::uint64_t blob_alignment = 16;
+
+    struct Header
+    {
+        std::array<char, 8> magic;
+        std::uint32_t version;
+        std::uint32_t entry_count;
+        std::uint64_t index_offset;
+        std::uint64_t strings_offset;
+        std::uint64_t strings_size;
+    };
+
+    struct Entry
+    {
+        std::uint64_t path_hash;
+        std::uint64_t data_offset;
+        std::uint64_t data_size;
+        std::uint32_t path_offset;
+        std::uint32_t path_size;
+    };
+
+    static_assert(sizeof(Header) == 40 && std::is_trivially_copyable_v<Header>);
+    static_assert(sizeof(Entry) == 32 && std::is_trivially_copyable_v<Entry>);
+
+    // FNV-1a
+    [[nodiscard]] constexpr auto hash_path(std::string_view const path) noexcept -> std::uint64_t
+    {
+        auto hash = std::uint64_t{ 0xcbf29ce484222325 };
+        for (auto const c : path) {
+            hash ^= static_cast<std::uint8_t>(c);
+            hash *= std::uint64_t{ 0x100000001b3 };
+        }
+        return hash;
+    }
+
+    // the key of a path inside a pack, e.g. "./pngs//image.png" -> "pngs/image.png", and "." -> "".
+    [[nodiscard]] inline auto normalize_path(std::filesystem::path const& path) -> std::string
+    {
+        auto str = path.lexically_normal().generic_string();
+        if (str == ".") {
+            str.clear();
+        }
+        while (!str.empty() && str.back() == '/') {
+            str.pop_back();
+        }
+        return str;
+    }
+
+    [[nodiscard]] constexpr auto align_up(std::uint64_t const value) noexcept -> std::uint64_t
+    {
+        return (value + blob_alignment - 1) / blob_alignment * blob_alignment;
+    }
+
+    [[nodiscard]] constexpr auto entry_less(Entry const& lhs, std::string_view const lhs_path, Entry const& rhs, std::string_view const rhs_path) noexcept -> bool
+    {
+        return lhs.path_hash != rhs.path_hash ? lhs.path_hash < rhs.path_hash : lhs_path < rhs_path;
+    }
+
+} // namespace asset_pack
+
+// A read-only asset pack mapped into memory. Looking up a file is a binary search over the index,
+// and its bytes are returned as a view into the mapping.
+class AssetPack
+{
+    std::shared_ptr<MappedFile const> m_file;
+    std::vector<asset_pack::Entry> m_entries;
+    std::string_view m_strings;
+    // every directory in the pack (the root is "") and its direct children, sorted.
+    HashMap<std::string, std::vector<std::filesystem::path>> m_directories;
+
+    AssetPack(std::shared_ptr<MappedFile const> file, std::vector<asset_pack::Entry> entries, std::string_view const strings)
+        : m_file(MOV(file))
+        , m_entries(MOV(entries))
+        , m_strings(strings)
+    {
+        m_directories[""];
+        for (auto const& entry : m_entries) {
+            auto child = std::string(path_of(entry));
+            for (auto slash = child.rfind('/'); ; slash = child.rfind('/')) {
+                auto parent = slash == std::string::npos ? std::string() : child.substr(0, slash);
+                auto [iter, inserted] = m_directories.try_emplace(parent);
+                iter->second.emplace_back(child);
+                // the parent was already linked to its own parent by an earlier entry.
+                if (!inserted || parent.empty()) {
+                    break;
+                }
+                child = MOV(parent);
+            }
+        }
+
+        for (auto& [dir, children] : m_directories) {
+            std::ranges::sort(children);
+        }
+    }
+
+    [[nodiscard]] auto path_of(asset_pack::Entry const& entry) const noexcept -> std::string_view
+    {
+        return m_strings.substr(entry.path_offset, entry.path_size);
+    }
+
+    [[nodiscard]] auto find_entry(std::string_view const path) const noexcept -> asset_pack::Entry const*
+    {
+        auto const hash = asset_pack::hash_path(path);
+        auto iter = std::ranges::lower_bound(m_entries, hash, {}, &asset_pack::Entry::path_hash);
+        for (; iter != m_entries.end() && iter->path_hash == hash; ++iter) {
+            if (path_of(*iter) == path) {
+                return std::addressof(*iter);
+            }
+        }
+        return nullptr;
+    }
+
+public:
+    [[nodiscard]] static auto open(std::filesystem::path const& path) -> tl::expected<AssetPack, std::error_code>
+    {
+        auto const corrupt = [] { return tl::make_unexpected(std::make_error_code(std::errc::illegal_byte_sequence)); };
+
+        auto mapped = MappedFile::open(path);
+        if (!mapped) {
+            return tl::make_unexpected(mapped.error());
+        }
+        auto file = std::make_shared<MappedFile const>(*MOV(mapped));
+        auto const bytes = file->bytes();
+
+        auto header = asset_pack::Header{};
+        if (bytes.size() < sizeof(header)) {
+            return corrupt();
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        if (header.magic != asset_pack::magic || header.version != asset_pack::version) {
+            return corrupt();
+        }
+
+        auto const index_size = std::uint64_t{ header.entry_count } * sizeof(asset_pack::Entry);
+        if (header.index_offset > bytes.size() || index_size > bytes.size() - header.index_offset
+            || header.strings_offset > bytes.size() || header.strings_size > bytes.size() - header.strings_offset) {
+            return corrupt();
+        }
+
+        // the index is copied out of the mapping, so the entries are properly aligned.
+        auto entries = std::vector<asset_pack::Entry>(header.entry_count);
+        std::memcpy(entries.data(), bytes.data() + header.index_offset, index_size);
+
+        auto const strings = std::string_view(reinterpret_cast<char const*>(bytes.data() + header.strings_offset), header.strings_size);
+        for (auto const& entry : entries) {
+            bool const valid = entry.path_offset <= strings.size() && entry.path_size <= strings.size() - entry.path_offset
+                && entry.data_offset <= bytes.size() && entry.data_size <= bytes.size() - entry.data_offset
+                && entry.path_hash == asset_pack::hash_path(strings.substr(entry.path_offset, entry.path_size));
+            if (!valid) {
+                return corrupt();
+            }
+        }
+
+        return AssetPack(MOV(file), MOV(entries), strings);
+    }
+
+    AssetPack(AssetPack&&) noexcept = default;
+    AssetPack& operator=(AssetPack&&) noexcept = default;
+
+    // the bytes of the file at `path` (relative to the packed folder), they keep the pack mapped while alive.
+    [[nodiscard]] auto find(std::filesystem::path const& path) const -> tl::optional<AssetBytes>
+    {
+        auto const* const entry = find_entry(asset_pack::normalize_path(path));
+        if (entry == nullptr) {
+            return tl::nullopt;
+        }
+        return AssetBytes(m_file, m_file->bytes().subspan(entry->data_offset, entry->data_size));
+    }
+
+    [[nodiscard]] auto is_directory(std::filesystem::path const& path) const -> bool
+    {
+        return m_directories.contains(asset_pack::normalize_path(path));
+    }
+
+    // the files and directories directly inside `dir`, relative to the packed folder.
+    [[nodiscard]] auto read_directory(std::filesystem::path const& dir) const -> tl::optional<std::vector<std::filesystem::path> const&>
+    {
+        auto const iter = m_directories.find(asset_pack::normalize_path(dir));
+        if (iter == m_directories.end()) {
+            return tl::nullopt;
+        }
+        return iter->second;
+    }
+
+    [[nodiscard]] auto len() const noexcept -> std::size_t
+    {
+        return m_entries.size();
+    }
+};
+
+// Packs every regular file below `folder` into a single pack at `output`, returns the number of packed files.
+[[nodiscard]] inline auto write_asset_pack(std::filesystem::path const& folder, std::filesystem::path const& output) -> tl::expected<std::size_t, std::error_code>
+{
+    namespace fs = std::filesystem;
+
+    struct PackedFile
+    {
+        fs::path source;
+        std::string path;
+        asset_pack::Entry entry;
+    };
+
+    auto ec = std::error_code{};
+    auto files = std::vector<PackedFile>{};
+    for (auto iter = fs::recursive_directory_iterator(folder, ec); !ec && iter != fs::recursive_directory_iterator(); iter.increment(ec)) {
+        if (!iter->is_regular_file(ec)) {
+            continue;
+        }
+
+        auto path = asset_pack::normalize_path(fs::relative(iter->path(), folder, ec));
+        auto const size = iter->file_size(ec);
+        if (ec) {
+            break;
+        }
+
+        auto const entry = asset_pack::Entry{ .path_hash = asset_pack::hash_path(path), .data_offset = 0, .data_size = size, .path_offset = 0, .path_size = 0 };
+        files.push_back(PackedFile{ .source = iter->path(), .path = MOV(path), .entry = entry });
+    }
+    if (ec) {
+        return tl::make_unexpected(ec);
+    }
+
+    std::ranges::sort(files, [](PackedFile const& lhs, PackedFile const& rhs) {
+        return asset_pack::entry_less(lhs.entry, lhs.path, rhs.entry, rhs.path);
+    });
+
+    auto strings = std::string{};
+    for (auto& file : files) {
+        file.entry.path_offset = static_cast<std::uint32_t>(strings.size());
+        file.entry.path_size = static_cast<std::uint32_t>(file.path.size());
+        strings += file.path;
+    }
+
+    auto header = asset_pack::Header{
+        .magic = asset_pack::magic,
+        .version = asset_pack::version,
+        .entry_count = static_cast<std::uint32_t>(files.size()),
+        .index_offset = sizeof(asset_pack::Header),
+        .strings_offset = sizeof(asset_pack::Header) + files.size() * sizeof(asset_pack::Entry),
+        .strings_size = strings.size(),
+    };
+
+    auto offset = asset_pack::align_up(header.strings_offset + header.strings_size);
+    for (auto& file : files) {
+        file.entry.data_offset = offset;
+        offset = asset_pack::align_up(offset + file.entry.data_size);
+    }
+
+    auto out = std::ofstream(output, std::ios::binary | std::ios::trunc);
+    auto const write = [&out](void const* const data, std::size_t const size) {
+        out.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+    };
+    auto const pad_to = [&out, &write](std::uint64_t const target) {
+        static constexpr auto zeros = std::array<char, asset_pack::blob_alignment>{};
+        auto const position = static_cast<std::uint64_t>(out.tellp());
+        write(zeros.data(), static_cast<std::size_t>(target - position));
+    };
+
+    write(&header, sizeof(header));
+    for (auto const& file : files) {
+        write(&file.entry, sizeof(file.entry));
+    }
+    write(strings.data(), strings.size());
+
+    for (auto const& file : files) {
+        pad_to(file.entry.data_offset);
+        auto in = std::ifstream(file.source, std::ios::binary);
+        if (file.entry.data_size > 0) {
+            out << in.rdbuf();
+        }
+        if (!in || static_cast<std::uint64_t>(out.tellp()) != file.entry.data_offset + file.entry.data_size) {
+            return tl::make_unexpected(std::make_error_code(std::errc::io_error));
+        }
+    }
+    pad_to(offset);
+
+    out.flush();
+    if (!out) {
+        return tl::make_unexpected(std::make_error_code(std::errc::io_error));
+    }
+    return files.size();
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <tl/expected.hpp>
+#include <util/common.hpp>
+#include <util/containers/hash.hpp>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+    #include <array>
+    #include <cerrno>
+    #include <cstring>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+// Watches every file below a folder for writes (inotify on Linux, unsupported elsewhere).
+// A burst of writes to the same file, e.g. an editor saving in several chunks, is reported once
+// after the file has been quiet for `debounce`.
+class FileWatcher
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+private:
+    std::filesystem::path m_root;
+    clock::duration m_debounce;
+    // changed files relative to `m_root` (in generic format), and when they were last written.
+    HashMap<std::string, clock::time_point> m_pending;
+
+#ifdef __linux__
+    int m_fd = -1;
+    // watch descriptor -> watched directory, relative to `m_root`.
+    HashMap<int, std::filesystem::path> m_watches;
+
+    static constexpr std::uint32_t file_mask = IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE;
+    static constexpr std::uint32_t dir_mask = file_mask | IN_ONLYDIR;
+
+    FileWatcher(std::filesystem::path root, clock::duration const debounce, int const fd) noexcept
+        : m_root(MOV(root))
+        , m_debounce(debounce)
+        , m_fd(fd)
+    {}
+
+    // inotify does not watch subdirectories, so every directory below `dir` gets its own watch.
+    void watch_recursive(std::filesystem::path const& dir)
+    {
+        auto const full_path = m_root / dir;
+        if (auto const wd = inotify_add_watch(m_fd, full_path.c_str(), dir_mask); wd >= 0) {
+            m_watches.insert_or_assign(wd, dir.lexically_normal());
+        }
+
+        auto ec = std::error_code{};
+        for (auto iter = std::filesystem::directory_iterator(full_path, ec); !ec && iter != std::filesystem::directory_iterator(); iter.increment(ec)) {
+            if (iter->is_directory(ec)) {
+                watch_recursive(dir / iter->path().filename());
+            }
+        }
+    }
+#else
+    FileWatcher(std::filesystem::path root, clock::duration const debounce) noexcept
+        : m_root(MOV(root))
+        , m_debounce(debounce)
+    {}
+#endif
+
+public:
+    [[nodiscard]] static auto create(std::filesystem::path root, clock::duration const debounce = std::chrono::milliseconds(50)) -> tl::expected<FileWatcher, std::error_code>
+    {
+#ifdef __linux__
+        auto const fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            return tl::make_unexpected(std::error_code(errno, std::system_category()));
+        }
+
+        auto watcher = FileWatcher(MOV(root), debounce, fd);
+        watcher.watch_recursive(".");
+        if (watcher.m_watches.empty()) {
+            return tl::make_unexpected(std::make_error_code(std::errc::not_a_directory));
+        }
+        return watcher;
+#else
+        UNUSED(root);
+        UNUSED(debounce);
+        return tl::make_unexpected(std::make_error_code(std::errc::not_supported));
+#endif
+    }
+
+    FileWatcher(FileWatcher const&) = delete;
+    FileWatcher& operator=(FileWatcher const&) = delete;
+
+#ifdef __linux__
+    FileWatcher(FileWatcher&& other) noexcept
+        : m_root(MOV(other.m_root))
+        , m_debounce(other.m_debounce)
+        , m_pending(MOV(other.m_pending))
+        , m_fd(std::exchange(other.m_fd, -1))
+        , m_watches(MOV(other.m_watches))
+    {}
+
+    FileWatcher& operator=(FileWatcher&& other) noexcept
+    {
+        if (this != &other) {
+            if (m_fd >= 0) {
+                ::close(m_fd);
+            }
+            m_root = MOV(other.m_root);
+            m_debounce = other.m_debounce;
+            m_pending = MOV(other.m_pending);
+            m_fd = std::exchange(other.m_fd, -1);
+            m_watches = MOV(other.m_watches);
+        }
+        return *this;
+    }
+
+    ~FileWatcher() noexcept
+    {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+#else
+    FileWatcher(FileWatcher&&) noexcept = default;
+    FileWatcher& operator=(FileWatcher&&) noexcept = default;
+#endif
+
+    [[nodiscard]] auto root() const noexcept -> std::filesystem::path const&
+    {
+        return m_root;
+    }
+
+    // the files (relative to `root()`) that have been written to and then left alone for `debounce`, sorted.
+    // never blocks, changes still within their debounce window are reported by a later call.
+    [[nodiscard]] auto poll(clock::time_point const now = clock::now()) -> std::vector<std::filesystem::path>
+    {
+#ifdef __linux__
+        alignas(inotify_event) auto buffer = std::array<char, 4096>{};
+        for (;;) {
+            auto const size = ::read(m_fd, buffer.data(), buffer.size());
+            if (size <= 0) {
+                break;
+            }
+
+            for (auto offset = std::size_t{ 0 }; offset < static_cast<std::size_t>(size);) {
+                auto event = inotify_event{};
+                std::memcpy(&event, buffer.data() + offset, sizeof(event));
+                auto const name = std::string(buffer.data() + offset + sizeof(event));
+                offset += sizeof(event) + event.len;
+
+                if (event.mask & IN_IGNORED) {
+                    m_watches.erase(event.wd);
+                    continue;
+                }
+
+                auto const dir = m_watches.find(event.wd);
+                if (dir == m_watches.end() || name.empty()) {
+                    continue;
+                }
+
+                auto const path = (dir->second / name).lexically_normal();
+                if (event.mask & IN_ISDIR) {
+                    if (event.mask & (IN_CREATE | IN_MOVED_TO)) {
+                        watch_recursive(path);
+                    }
+                    continue;
+                }
+                m_pending.insert_or_assign(path.generic_string(), now);
+            }
+        }
+#endif
+
+        auto settled = std::vector<std::filesystem::path>{};
+        for (auto iter = m_pending.begin(); iter != m_pending.end();) {
+            if (now - iter->second >= m_debounce) {
+                settled.emplace_back(iter->first);
+                m_pending.erase(iter++);
+            }
+            else {
+                ++iter;
+            }
+        }
+        std::ranges::sort(settled);
+        return settled;
+    }
+};
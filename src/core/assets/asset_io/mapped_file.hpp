@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <system_error>
+#include <tl/expected.hpp>
+#include <utility>
+#include <util/common.hpp>
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// A whole file mapped read-only into memory, unmapped on destruction.
+// Empty files are not mapped and yield an empty view.
+class MappedFile
+{
+    void* m_data = nullptr;
+    std::size_t m_size = 0;
+
+    constexpr MappedFile(void* const data, std::size_t const size) noexcept
+        : m_data(data)
+        , m_size(size)
+    {}
+
+    void unmap() noexcept
+    {
+        if (m_data == nullptr) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+#else
+        munmap(m_data, m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+public:
+    MappedFile(MappedFile const&) = delete;
+    MappedFile& operator=(MappedFile const&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+    {}
+
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other) {
+            unmap();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() noexcept
+    {
+        unmap();
+    }
+
+    [[nodiscard]] static auto open(std::filesystem::path const& path) -> tl::expected<MappedFile, std::error_code>
+    {
+#ifdef _WIN32
+        auto const last_error = [] { return std::error_code(static_cast<int>(GetLastError()), std::system_category()); };
+
+        auto const file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return tl::make_unexpected(last_error());
+        }
+
+        auto size = LARGE_INTEGER{};
+        if (!GetFileSizeEx(file, &size)) {
+            auto const ec = last_error();
+            CloseHandle(file);
+            return tl::make_unexpected(ec);
+        }
+
+        if (size.QuadPart == 0) {
+            CloseHandle(file);
+            return MappedFile(nullptr, 0);
+        }
+
+        // the view keeps the mapping (and the file) alive, so both handles can be closed straight away.
+        auto const mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (mapping == nullptr) {
+            return tl::make_unexpected(last_error());
+        }
+
+        auto* const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        auto const ec = last_error();
+        CloseHandle(mapping);
+        if (data == nullptr) {
+            return tl::make_unexpected(ec);
+        }
+
+        return MappedFile(data, static_cast<std::size_t>(size.QuadPart));
+#else
+        auto const last_error = [] { return std::error_code(errno, std::system_category()); };
+
+        auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return tl::make_unexpected(last_error());
+        }
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            auto const ec = last_error();
+            ::close(fd);
+            return tl::make_unexpected(ec);
+        }
+
+        if (!S_ISREG(st.st_mode)) {
+            ::close(fd);
+            return tl::make_unexpected(std::make_error_code(std::errc::not_supported));
+        }
+
+        auto const size = static_cast<std::size_t>(st.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return MappedFile(nullptr, 0);
+        }
+
+        // the mapping keeps the file alive, so the descriptor can be closed straight away.
+        auto* const data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        auto const ec = last_error();
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return tl::make_unexpected(ec);
+        }
+
+        // assets are decoded front to back, let the kernel read ahead aggressively.
+        ::madvise(data, size, MADV_SEQUENTIAL);
+        return MappedFile(data, size);
+#endif
+    }
+
+    [[nodiscard]] auto bytes() const noexcept -> std::span<std::byte const>
+    {
+        return { static_cast<std::byte const*>(m_data), m_size };
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return m_size; }
+};
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <deque>
 #include <filesystem>
 #include <memory>
 #include <spdlog/spdlog.h>
@@ -11,10 +15,13 @@
 #include <debug/debug.hpp>
 #include <util/common.hpp>
 #include <util/containers/hash.hpp>
+#include <util/sync/mutex.hpp>
 #include <util/sync/rwlock.hpp>
+#include <core/diagnostics/trace.hpp>
 #include <core/ecs/resource.hpp>
 #include <core/task/task_pool.hpp>
 
+#include "asset_cache.hpp"
 #include "assets.hpp"
 #include "asset_io/asset_io.hpp"
 #include "handle.hpp"
@@ -37,6 +44,22 @@ enum class LoadState
     Failed,
 };
 
+// Queued loads start in priority order, e.g. a `Visible` load jumps ahead of every queued `Prefetch`.
+// Every priority is asynchronous, `load_sync` is the one that blocks the caller.
+enum class LoadPriority
+{
+    Highest,
+    Visible,
+    Prefetch,
+};
+
+// How many queued loads may be reading their file, and how many may be decoding it, at the same time.
+struct AssetLoadLimits
+{
+    std::size_t max_reads = 4;
+    std::size_t max_decodes = 4;
+};
+
 struct AssetInfo
 {
     std::filesystem::path   path;
@@ -58,14 +81,47 @@ namespace as_detail {
         RwLock<HashMap<HandleId, std::size_t>> ref_counts;
     };
 
+    inline constexpr std::size_t load_priority_count = 3;
+
+    // a load of one version of an asset, it is cancelled once that version is no longer the asset's current one.
+    struct LoadTicket
+    {
+        std::filesystem::path path;
+        AssetPathId path_id;
+        std::size_t version;
+        // the state to go back to if this version fails to load.
+        LoadState failed_state;
+        std::shared_ptr<AssetLoader> loader;
+        LoadPriority priority;
+    };
+
+    struct PendingDecode
+    {
+        LoadTicket ticket;
+        AssetBytes bytes;
+    };
+
+    struct LoadQueue
+    {
+        // indexed by `LoadPriority`
+        std::array<std::deque<LoadTicket>, load_priority_count> reads;
+        std::array<std::deque<PendingDecode>, load_priority_count> decodes;
+        std::size_t reads_in_flight = 0;
+        std::size_t decodes_in_flight = 0;
+        AssetLoadLimits limits;
+    };
+
     struct AssetServerInternal
     {
         AssetServerInternal(std::unique_ptr<AssetIo> asset_io, TaskPool taskpool)
-            : asset_io(MOV(asset_io))
+            : task_pool(MOV(taskpool))
+            , asset_io(MOV(asset_io))
             , ref_counter(AssetRefCounter{
                 .channel = RefChangeChannel::create(),
                 })
-            , task_pool(MOV(taskpool))
+            , load_queue(Mutex<LoadQueue>::create(LoadQueue{
+                .limits = AssetLoadLimits{ .max_decodes = std::max<std::size_t>(task_pool.thread_count(), 1) },
+                }))
         {}
 
         AssetServerInternal(AssetServerInternal&&) noexcept = default;
@@ -74,11 +130,17 @@ namespace as_detail {
         TaskPool task_pool;
         std::unique_ptr<AssetIo> asset_io;
         AssetRefCounter ref_counter;
+        // lock order: `extension_to_loader_index` before `loaders`.
         RwLock<std::vector<std::shared_ptr<AssetLoader>>> loaders;
         RwLock<HashMap<std::string, std::size_t, hash::string_hash, hash::string_equal>> extension_to_loader_index;
         RwLock<HashMap<AssetPathId, AssetInfo>> asset_info;
         RwLock<HashMap<type_id_t, std::vector<StoredAsset>>> stored_assets;
         RwLock<HashMap<type_id_t, std::vector<HandleId>>> assets_to_free;
+        RwLock<std::shared_ptr<AssetCache const>> cache;
+        // lock order: `load_queue` before `asset_info`.
+        Mutex<LoadQueue> load_queue;
+        // versions are never reused, not even after an asset's info has been dropped.
+        std::atomic<std::size_t> next_version{ 0 };
     };
 }
 
@@ -86,6 +148,8 @@ class AssetServer
 {
     std::shared_ptr<as_detail::AssetServerInternal> m_internal;
     using StoredAsset = as_detail::StoredAsset;
+    using LoadTicket = as_detail::LoadTicket;
+    using PendingDecode = as_detail::PendingDecode;
 
 public:
 
@@ -142,8 +206,9 @@ public:
     {
         auto loader = std::make_unique<T>(FWD(args)...);
 
-        auto loaders = m_internal->loaders.write();
+        // same lock order as `get_asset_loader_from_extension`
         auto extension_map = m_internal->extension_to_loader_index.write();
+        auto loaders = m_internal->loaders.write();
 
         auto const index = loaders->size();
         for (auto const extension : loader->extensions()) {
@@ -152,6 +217,17 @@ public:
         loaders->push_back(MOV(loader));
     }
 
+    // decoded assets are looked up in `cache` before their loader runs, and written to it after a successful decode.
+    void set_asset_cache(AssetCache cache)
+    {
+        *m_internal->cache.write() = std::make_shared<AssetCache const>(MOV(cache));
+    }
+
+    [[nodiscard]] auto asset_cache() const -> std::shared_ptr<AssetCache const>
+    {
+        return *m_internal->cache.read();
+    }
+
     [[nodiscard]] auto get_asset_loader_from_extension(std::string_view const extension) const -> tl::optional<std::shared_ptr<AssetLoader>>
     {
         auto index_map = m_internal->extension_to_loader_index.read();
@@ -201,135 +277,159 @@ public:
     // TODO: Make async??
     [[nodiscard]] auto load_sync(std::filesystem::path const& path) const -> AssetServerResult<AssetPathId>
     {
-        auto loader = get_asset_loader_from_path(path);
-        if (!loader) {
-            return tl::make_unexpected(Error::MissingAssetLoader);
-        }
+        return load_versioned(path, false);
+    }
 
-        auto const path_id = HandleId::from_path(path).m_path_id;
+    // loads `path` again if it has been loaded before, e.g. because its file changed.
+    // the new version replaces the old one through `Assets<T>::set_asset`, which sends `AssetEvent<T>::modified`.
+    [[nodiscard]] auto reload_sync(std::filesystem::path const& path) const -> AssetServerResult<AssetPathId>
+    {
+        return load_versioned(path, true);
+    }
 
-        auto const version_opt = [&]() -> tl::optional<std::size_t> {
-            auto asset_info = m_internal->asset_info.write();
-            
-            auto const [iter, inserted] = 
-                asset_info->emplace(std::piecewise_construct,
-                    std::forward_as_tuple(path_id), 
-                    std::forward_as_tuple( // AssetPathInfo
-                        path, // path
-                        LoadState::NotLoaded, // load_state
-                        tl::nullopt, // type_id
-                        0 // version
-                    ));
-
-            // TODO: Possibly give the option to force the asset to reload?
-            //       Also, if the asset is already loaded, should we remove the info?
-            // When this is updated: I'll have to update the `update_assets` to ensure versions match
-            if (!inserted) {// asset already exists
-                return {};
-            }
+    // decodes `bytes` with `loader`, going through the asset cache if both the cache and the loader are set up for it.
+    [[nodiscard]] auto load_asset(AssetLoader const& loader, std::filesystem::path const& path, std::span<std::byte const> const bytes) const -> tl::optional<LoadedAsset>
+    {
+        auto const cache = asset_cache();
+        auto const cache_version = loader.cache_version();
+        if (cache == nullptr || !cache_version.has_value()) {
+            TRACE_SCOPE("AssetLoader::load", "asset decode");
+            return loader.load(path, bytes);
+        }
 
-            auto& info = iter->second;
-            info.load_state = LoadState::Loading;
-            info.version += 1;
-            return info.version;
+        auto const tag = path.extension().string();
+        auto const key = [&] {
+            TRACE_SCOPE("asset_cache::content_hash", "asset cache");
+            return asset_cache::Key::from_source(bytes, std::string_view(tag).substr(tag.empty() ? 0 : 1), *cache_version);
         }();
 
-        if (!version_opt) {
-            return path_id;
+        if (auto const cached = cache->find(key); cached) {
+            TRACE_SCOPE("AssetLoader::load_cached", "asset cache");
+            if (auto asset = loader.load_cached(path, cached->span()); asset) {
+                return asset;
+            }
+            LOG_WARN("AssetCache entry of '{}' could not be loaded, decoding it again.", path.string());
         }
 
-        auto const version = *version_opt;
-
-        auto set_load_state = [&](LoadState const state) {
-            auto asset_info = m_internal->asset_info.write();
-            auto info = asset_info->find(path_id);
-            DEBUG_ASSERT(info != asset_info->end(), "Unable to find path_id: {}", path_id);
-            info->second.load_state = state;
-        };
+        auto asset = [&] {
+            TRACE_SCOPE("AssetLoader::load", "asset decode");
+            return loader.load(path, bytes);
+        }();
+        if (!asset) {
+            return asset;
+        }
 
-        // load the asset file's bytes
-        auto bytes = m_internal->asset_io->load_path(path)();
-        if (!bytes) {
-            set_load_state(LoadState::Failed);
-            return tl::make_unexpected(Error::AssetIoError);
+        TRACE_SCOPE("AssetCache::store", "asset cache");
+        auto payload = std::vector<std::byte>{};
+        if (loader.write_cache(*asset, payload) && !cache->store(key, payload)) {
+            LOG_WARN("Unable to write the AssetCache entry of '{}' to '{}'.", path.string(), cache->folder().string());
         }
+        return asset;
+    }
 
-        // loaded the asset from the asset file's bytes
-        auto loaded_asset = (*loader)->load(path, *bytes);
-        if (!loaded_asset) {
-            set_load_state(LoadState::Failed);
-            return tl::make_unexpected(Error::AssetLoaderError);
+    // queues `path` to be loaded on the task pool, see `set_load_limits`.
+    // an asset that is already queued is moved up to `priority` if that is higher.
+    [[nodiscard]] auto load_untracked(std::filesystem::path const& path, LoadPriority const priority = LoadPriority::Visible) const -> HandleId
+    {
+        auto const id = HandleId::from_path(path);
+        if (auto ticket = begin_load(path, false, priority); !ticket) {
+            spdlog::error("AssetServer failed to load assets: '{}'", path.string());
+        }
+        else if (ticket->has_value()) {
+            enqueue_load(**MOV(ticket));
+        }
+        else {
+            promote_load(id.m_path_id, priority);
         }
+        return id;
+    }
 
-        // Check if version has changed since we last had the lock. 
-        // Return if a newer version is being loaded.
-        {
-            auto asset_info = m_internal->asset_info.write();
-            auto info = asset_info->find(path_id);
-            DEBUG_ASSERT(info != asset_info->end(), "Unable to find path_id: {}", path_id);
+    void reload_untracked(std::filesystem::path const& path) const
+    {
+        if (auto ticket = begin_load(path, true, LoadPriority::Visible); !ticket) {
+            spdlog::error("AssetServer failed to reload asset: '{}'", path.string());
+        }
+        else if (ticket->has_value()) {
+            enqueue_load(**MOV(ticket));
+        }
+    }
 
-            if (version != info->second.version) {
-                return path_id;
-            }
+    // caps the queued loads that read or decode at the same time, by default decodes are capped at the task pool's thread count.
+    void set_load_limits(AssetLoadLimits const limits)
+    {
+        DEBUG_ASSERT(limits.max_reads > 0 && limits.max_decodes > 0, "AssetLoadLimits must allow at least one read and one decode");
+        m_internal->load_queue.lock()->limits = limits;
+        pump_load_queue();
+    }
 
-            info->second.type_id = tl::make_optional(loaded_asset->type_id());
-            info->second.load_state = LoadState::Loaded;
+    // the number of loads waiting for a read, cancelled loads are dropped once the ref count update notices them.
+    [[nodiscard]] auto queued_load_count() const -> std::size_t
+    {
+        auto queue = m_internal->load_queue.lock();
+        auto count = std::size_t{ 0 };
+        for (auto const& reads : queue->reads) {
+            count += reads.size();
         }
+        return count;
+    }
 
-        // store the loaded asset
-        auto stored_assets = m_internal->stored_assets.write();
-        auto [assets, unused] = stored_assets->emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(loaded_asset->type_id()),
-            std::forward_as_tuple()
-        );
-        UNUSED(unused);
-        assets->second.push_back(StoredAsset{
-            .data = MOV(loaded_asset->m_data),
-            .path_id = path_id,
-            });
-
-        return path_id;
+    // starts watching the asset files for changes, returns false if the `AssetIo` can not watch them.
+    auto watch_for_changes() -> bool
+    {
+        return m_internal->asset_io->watch_for_changes();
     }
 
-    [[nodiscard]] auto load_untracked(std::filesystem::path const& path) const -> HandleId
+    // reloads, on the task pool, every tracked asset whose file changed since the last call.
+    void reload_changed_assets() const
     {
-        // TODO: Revamp TaskPool to return a `future` like object
-         m_internal->task_pool.execute([server = *this, path = path]{
-            if (auto const result = server.load_sync(path); !result) {
-                spdlog::error("AssetServer failed to load assets: '{}'", path.string());
+        auto const changed = m_internal->asset_io->changed_paths();
+        if (changed.empty()) {
+            return;
+        }
+
+        auto const tracked = [&] {
+            auto asset_info = m_internal->asset_info.read();
+            auto tracked = std::vector<std::filesystem::path>{};
+            for (auto const& path : changed) {
+                if (asset_info->contains(HandleId::from_path(path).m_path_id)) {
+                    tracked.push_back(path);
+                }
             }
-            });
-        return HandleId::from_path(path);
+            return tracked;
+        }();
+
+        for (auto const& path : tracked) {
+            reload_untracked(path);
+        }
     }
 
-    [[nodiscard]] auto load_untyped(std::filesystem::path const& path) const -> UntypedHandle
+    [[nodiscard]] auto load_untyped(std::filesystem::path const& path, LoadPriority const priority = LoadPriority::Visible) const -> UntypedHandle
     {
-        auto const id = load_untracked(path);
+        auto const id = load_untracked(path, priority);
         return get_untyped_handle(id);
     }
 
     template <typename T>
-    [[nodiscard]] auto load(std::filesystem::path const& path) const -> Handle<T>
+    [[nodiscard]] auto load(std::filesystem::path const& path, LoadPriority const priority = LoadPriority::Visible) const -> Handle<T>
     {
-        return load_untyped(path).typed<T>();
+        return load_untyped(path, priority).typed<T>();
     }
 
-    [[nodiscard]] auto load_folder(std::filesystem::path const& dir) const -> tl::expected<std::vector<UntypedHandle>, Error>
+    [[nodiscard]] auto load_folder(std::filesystem::path const& dir, LoadPriority const priority = LoadPriority::Visible) const -> tl::expected<std::vector<UntypedHandle>, Error>
     {
         if (!m_internal->asset_io->is_directory(dir)) {
             return tl::make_unexpected(AssetFolderNotADirectory);
         }
 
         auto handles = std::vector<UntypedHandle>{};
-        auto iter = m_internal->asset_io->read_directory(dir);
-        if (!iter) {
+        auto children = m_internal->asset_io->read_directory(dir);
+        if (!children) {
             return tl::make_unexpected(AssetIoError);
         }
 
-        for (auto const& child_path : *iter) {
-            if (m_internal->asset_io->is_directory(child_path.path())) {
-                auto inner_handles = load_folder(child_path);
+        for (auto const& child_path : *children) {
+            if (m_internal->asset_io->is_directory(child_path)) {
+                auto inner_handles = load_folder(child_path, priority);
                 if (!inner_handles) {
                     return tl::make_unexpected(inner_handles.error());
                 }
@@ -340,10 +440,10 @@ public:
                 );
             }
             else {
-                if (!get_asset_loader_from_path(child_path.path().string()).has_value()) {
+                if (!get_asset_loader_from_path(child_path.string()).has_value()) {
                     continue;
                 }
-                handles.emplace_back(load_untyped(child_path));
+                handles.emplace_back(load_untyped(child_path, priority));
             }
         }
 
@@ -383,8 +483,12 @@ public:
                 }
         }
 
-        if (!potential_frees.empty()) {
-            
+        if (potential_frees.empty()) {
+            return;
+        }
+
+        auto cancelled_loads = false;
+        {
             auto assets_to_free = m_internal->assets_to_free.write();
             auto asset_info = m_internal->asset_info.write();
 
@@ -395,6 +499,8 @@ public:
                     // get type_id_t and possilby erase from the `asset_info`.
                     if (id.m_is_path_id) {
                         if (auto const iter = asset_info->find(id.m_path_id); iter != asset_info->end()) {
+                            // dropping the info cancels an unfinished load, it is no longer current.
+                            cancelled_loads |= iter->second.load_state == LoadState::Loading;
                             auto const tid = iter->second.type_id;
                             asset_info->erase(iter);
                             return tid;
@@ -411,6 +517,11 @@ public:
                 }
             }
         }
+
+        // `asset_info` must be unlocked first, the load queue is always locked before it.
+        if (cancelled_loads) {
+            prune_load_queue();
+        }
     }
 
     template <typename T>
@@ -458,6 +569,260 @@ public:
             assets.remove_asset(id);
         }
     }
+
+private:
+    // registers a new version of `path`, or returns no ticket if there is nothing to load:
+    // the asset is already tracked (when loading) or is not tracked (when reloading).
+    [[nodiscard]] auto begin_load(std::filesystem::path const& path, bool const reload, LoadPriority const priority) const -> AssetServerResult<tl::optional<LoadTicket>>
+    {
+        auto loader = get_asset_loader_from_path(path);
+        if (!loader) {
+            return tl::make_unexpected(Error::MissingAssetLoader);
+        }
+
+        auto const path_id = HandleId::from_path(path).m_path_id;
+
+        auto asset_info = m_internal->asset_info.write();
+        auto failed_state = LoadState::Failed;
+
+        auto iter = asset_info->find(path_id);
+        if (reload) {
+            // only assets that are already tracked are reloaded.
+            if (iter == asset_info->end()) {
+                return tl::optional<LoadTicket>{};
+            }
+            if (iter->second.load_state == LoadState::Loaded) {
+                failed_state = LoadState::Loaded;
+            }
+        }
+        else {
+            // TODO: if the asset is already loaded, should we remove the info?
+            if (iter != asset_info->end()) { // asset already exists, use `reload_sync` to load it again
+                return tl::optional<LoadTicket>{};
+            }
+            iter = asset_info->emplace(std::piecewise_construct,
+                std::forward_as_tuple(path_id),
+                std::forward_as_tuple( // AssetPathInfo
+                    path, // path
+                    LoadState::NotLoaded, // load_state
+                    tl::nullopt, // type_id
+                    0 // version
+                )).first;
+        }
+
+        auto& info = iter->second;
+        info.load_state = LoadState::Loading;
+        info.version = ++m_internal->next_version;
+
+        return tl::make_optional(LoadTicket{
+            .path = path,
+            .path_id = path_id,
+            .version = info.version,
+            .failed_state = failed_state,
+            .loader = *MOV(loader),
+            .priority = priority,
+        });
+    }
+
+    // false once a newer version started loading, or every handle to the asset was dropped.
+    [[nodiscard]] auto is_current(LoadTicket const& ticket) const -> bool
+    {
+        auto asset_info = m_internal->asset_info.read();
+        auto const info = asset_info->find(ticket.path_id);
+        return info != asset_info->end() && info->second.version == ticket.version;
+    }
+
+    void fail_load(LoadTicket const& ticket) const
+    {
+        auto asset_info = m_internal->asset_info.write();
+        if (auto info = asset_info->find(ticket.path_id); info != asset_info->end() && info->second.version == ticket.version) {
+            info->second.load_state = ticket.failed_state;
+        }
+    }
+
+    [[nodiscard]] auto read_asset(LoadTicket const& ticket) const -> AssetServerResult<AssetBytes>
+    {
+        auto bytes = [&] {
+            TRACE_SCOPE("AssetIo::load_path", "asset io");
+            return m_internal->asset_io->load_path(ticket.path)();
+        }();
+        if (!bytes) {
+            fail_load(ticket);
+            return tl::make_unexpected(Error::AssetIoError);
+        }
+        return *MOV(bytes);
+    }
+
+    [[nodiscard]] auto decode_asset(LoadTicket const& ticket, std::span<std::byte const> const bytes) const -> AssetServerResult<AssetPathId>
+    {
+        auto loaded_asset = load_asset(*ticket.loader, ticket.path, bytes);
+        if (!loaded_asset) {
+            fail_load(ticket);
+            return tl::make_unexpected(Error::AssetLoaderError);
+        }
+
+        // Check if version has changed since we last had the lock. 
+        // Return if a newer version is being loaded, or the load was cancelled.
+        // The lock is held until the asset is stored, so an older version can never be stored after a newer one.
+        auto asset_info = m_internal->asset_info.write();
+        auto info = asset_info->find(ticket.path_id);
+        if (info == asset_info->end() || info->second.version != ticket.version) {
+            return ticket.path_id;
+        }
+
+        info->second.type_id = tl::make_optional(loaded_asset->type_id());
+        info->second.load_state = LoadState::Loaded;
+
+        // store the loaded asset
+        auto stored_assets = m_internal->stored_assets.write();
+        auto [assets, unused] = stored_assets->emplace(
+            std::piecewise_construct,
+            std::forward_as_tuple(loaded_asset->type_id()),
+            std::forward_as_tuple()
+        );
+        UNUSED(unused);
+        assets->second.push_back(StoredAsset{
+            .data = MOV(loaded_asset->m_data),
+            .path_id = ticket.path_id,
+            });
+
+        return ticket.path_id;
+    }
+
+    [[nodiscard]] auto load_versioned(std::filesystem::path const& path, bool const reload) const -> AssetServerResult<AssetPathId>
+    {
+        auto ticket = begin_load(path, reload, LoadPriority::Highest);
+        if (!ticket) {
+            return tl::make_unexpected(ticket.error());
+        }
+        if (!ticket->has_value()) {
+            return HandleId::from_path(path).m_path_id;
+        }
+
+        // the asset file's bytes are kept alive until the loader is done.
+        auto const bytes = read_asset(**ticket);
+        if (!bytes) {
+            return tl::make_unexpected(bytes.error());
+        }
+        return decode_asset(**ticket, bytes->span());
+    }
+
+    void enqueue_load(LoadTicket ticket) const
+    {
+        {
+            auto queue = m_internal->load_queue.lock();
+            auto const priority = static_cast<std::size_t>(ticket.priority);
+            queue->reads[priority].push_back(MOV(ticket));
+        }
+        pump_load_queue();
+    }
+
+    // moves a queued load of `path_id` up to `priority`, behind the loads already queued there.
+    void promote_load(AssetPathId const path_id, LoadPriority const priority) const
+    {
+        auto const target = static_cast<std::size_t>(priority);
+        auto const promote = [&](auto& queues, auto const& ticket_of) {
+            for (auto lower = target + 1; lower < queues.size(); ++lower) {
+                auto& from = queues[lower];
+                auto const iter = std::ranges::find_if(from, [&](auto const& entry) { return ticket_of(entry).path_id == path_id; });
+                if (iter != from.end()) {
+                    ticket_of(*iter).priority = priority;
+                    queues[target].push_back(MOV(*iter));
+                    from.erase(iter);
+                    return;
+                }
+            }
+        };
+
+        auto queue = m_internal->load_queue.lock();
+        promote(queue->reads, [](auto& ticket) -> auto& { return ticket; });
+        promote(queue->decodes, [](auto& pending) -> auto& { return pending.ticket; });
+    }
+
+    // drops every queued load that is no longer current, freeing the bytes of those already read.
+    void prune_load_queue() const
+    {
+        auto queue = m_internal->load_queue.lock();
+        for (auto& reads : queue->reads) {
+            std::erase_if(reads, [this](LoadTicket const& ticket) { return !is_current(ticket); });
+        }
+        for (auto& decodes : queue->decodes) {
+            std::erase_if(decodes, [this](PendingDecode const& pending) { return !is_current(pending.ticket); });
+        }
+    }
+
+    // starts as many queued loads as the limits allow, highest priority first.
+    // decodes start before reads, they finish loads that already hold their file's bytes.
+    void pump_load_queue() const
+    {
+        auto decodes = std::vector<PendingDecode>{};
+        auto reads = std::vector<LoadTicket>{};
+        {
+            auto queue = m_internal->load_queue.lock();
+            auto const take = [this](auto& queues, std::size_t& in_flight, std::size_t const max, auto& out, auto const& ticket_of) {
+                for (auto& from : queues) {
+                    while (in_flight < max && !from.empty()) {
+                        auto entry = MOV(from.front());
+                        from.pop_front();
+                        if (is_current(ticket_of(entry))) {
+                            ++in_flight;
+                            out.push_back(MOV(entry));
+                        }
+                    }
+                }
+            };
+            take(queue->decodes, queue->decodes_in_flight, queue->limits.max_decodes, decodes, [](PendingDecode const& pending) -> auto const& { return pending.ticket; });
+            take(queue->reads, queue->reads_in_flight, queue->limits.max_reads, reads, [](LoadTicket const& ticket) -> auto const& { return ticket; });
+        }
+
+        for (auto& pending : decodes) {
+            m_internal->task_pool.execute([server = *this, pending = MOV(pending)]{
+                server.run_decode(pending);
+                });
+        }
+        for (auto& ticket : reads) {
+            m_internal->task_pool.execute([server = *this, ticket = MOV(ticket)]{
+                server.run_read(ticket);
+                });
+        }
+    }
+
+    void run_read(LoadTicket const& ticket) const
+    {
+        // the load may have been cancelled while it waited for a thread.
+        auto bytes = tl::optional<AssetBytes>{};
+        if (is_current(ticket)) {
+            if (auto result = read_asset(ticket); result) {
+                bytes = *MOV(result);
+            }
+            else {
+                spdlog::error("AssetServer failed to load assets: '{}'", ticket.path.string());
+            }
+        }
+        {
+            auto queue = m_internal->load_queue.lock();
+            queue->reads_in_flight -= 1;
+            if (bytes) {
+                auto const priority = static_cast<std::size_t>(ticket.priority);
+                queue->decodes[priority].push_back(PendingDecode{ .ticket = ticket, .bytes = *MOV(bytes) });
+            }
+        }
+        pump_load_queue();
+    }
+
+    void run_decode(PendingDecode const& pending) const
+    {
+        if (is_current(pending.ticket)) {
+            if (auto const result = decode_asset(pending.ticket, pending.bytes.span()); !result) {
+                spdlog::error("AssetServer failed to load assets: '{}'", pending.ticket.path.string());
+            }
+        }
+        {
+            auto queue = m_internal->load_queue.lock();
+            queue->decodes_in_flight -= 1;
+        }
+        pump_load_queue();
+    }
 };
 
 void update_asset_ref_count_system(Resource<AssetServer const> server)
@@ -465,6 +830,11 @@ void update_asset_ref_count_system(Resource<AssetServer const> server)
     server->update_asset_ref_count();
 }
 
+void asset_hot_reload_system(Resource<AssetServer const> server)
+{
+    server->reload_changed_assets();
+}
+
 template <typename T>
 void update_assets_system(Resource<AssetServer const> server, Resource<Assets<T>> assets)
 {
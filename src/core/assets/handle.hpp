@@ -22,6 +22,8 @@ class Handle
         , m_sender(MOV(sender))
     {}
 
+    friend class UntypedHandle;
+
 public:
     Handle(Handle&& other) noexcept
         : m_id(other.m_id)
@@ -170,9 +172,10 @@ public:
             }
         }
 
+        // the strong reference is moved into the typed handle, it is not a new one.
         auto sender = m_sender.take();
         if (sender) {
-            return Handle<T>::strong(m_id, *MOV(sender));
+            return Handle<T>(m_id, *MOV(sender));
         }
         else {
             return Handle<T>::weak(m_id);
@@ -74,9 +74,10 @@ public:
     constexpr HandleId& operator=(HandleId&&) noexcept = default;
     constexpr HandleId& operator=(HandleId const&) noexcept = default;
 
+    // spellings of the same file (e.g. `./x.png`, `a/../x.png` and `x.png`) get the same id.
     [[nodiscard]] static auto from_path(std::filesystem::path const& path) -> HandleId
     {
-        auto const hash = std::filesystem::hash_value(path);
+        auto const hash = std::filesystem::hash_value(path.lexically_normal());
         return HandleId(AssetPathId { .id = hash });
     }
 
@@ -109,21 +110,17 @@ public:
     }
 };
 
-namespace {
-    [[nodiscard]] CONSTEXPR_BIT_CAST auto to_bytes(HandleId const& id) noexcept -> std::array<char, sizeof(HandleId)>
-    {
-        return bit_cast<std::array<char, sizeof(HandleId)>>(id);
-    }
-}
-
 template <>
 struct std::hash<HandleId>
 {
+    // only the active member is hashed, the rest of the union and the padding are indeterminate.
     auto operator()(HandleId const& id) const noexcept -> std::size_t
     {
-        auto bytes = to_bytes(id);
-        auto str = std::string_view{ bytes.data(), bytes.size() };
-        return std::hash<std::string_view>{}(str);
+        if (id.m_is_path_id) {
+            return std::hash<AssetPathId>{}(id.m_path_id);
+        }
+        auto const type_hash = std::hash<type_id_t>{}(id.m_uid.type_id);
+        return std::hash<std::uint64_t>{}(id.m_uid.id) ^ (type_hash + 0x9e3779b97f4a7c15 + (type_hash << 6) + (type_hash >> 2));
     }
 };
 
@@ -2,11 +2,13 @@
 
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <span>
 #include <string_view>
 #include <string>
 #include <tl/optional.hpp>
+#include <vector>
 
 #include <util/common.hpp>
 #include <util/void_ptr.hpp>
@@ -37,12 +39,40 @@ public:
     {
         return m_type_id;
     }
+
+    // the loaded `T`, or nullptr if this asset is not a `T`.
+    template <typename T>
+    [[nodiscard]] constexpr auto get() const noexcept -> T const*
+    {
+        return m_type_id == ::type_id<T>() ? static_cast<T const*>(m_data.cdata()) : nullptr;
+    }
 };
 
 struct AssetLoader
 {
     virtual auto extensions() const noexcept -> std::span<std::string_view const> = 0;
-    virtual auto load(std::filesystem::path const& path, std::span<std::byte> bytes) const -> tl::optional<LoadedAsset> = 0;
+    // `bytes` may be a read-only mapping of the file, it is only valid for the duration of the call.
+    virtual auto load(std::filesystem::path const& path, std::span<std::byte const> bytes) const -> tl::optional<LoadedAsset> = 0;
+
+    // Loaders with an expensive decode opt into the `AssetCache` by returning a version here,
+    // which must be bumped whenever the format written by `write_cache` changes.
+    virtual auto cache_version() const noexcept -> tl::optional<std::uint32_t> { return tl::nullopt; }
+
+    // appends `asset` in a form `load_cached` can rebuild it from, returns false if it can not be cached.
+    virtual auto write_cache(LoadedAsset const& asset, std::vector<std::byte>& out) const -> bool
+    {
+        UNUSED(asset);
+        UNUSED(out);
+        return false;
+    }
+
+    // `bytes` were written by `write_cache` of the same `cache_version()`, they are only valid for the duration of the call.
+    virtual auto load_cached(std::filesystem::path const& path, std::span<std::byte const> bytes) const -> tl::optional<LoadedAsset>
+    {
+        UNUSED(path);
+        UNUSED(bytes);
+        return tl::nullopt;
+    }
 };
 
 template <typename T>
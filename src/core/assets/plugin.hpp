@@ -2,18 +2,28 @@
 
 #include <core/assets/asset_server.hpp>
 #include <core/assets/asset_io/asset_io_impl.hpp>
+#include <debug/debug.hpp>
 #include <core/game/game.hpp>
 #include <core/task/task_pool.hpp>
 
 struct AssetServerSettings
 {
     std::string asset_folder = "assets";
+    // when set, assets are served from this pack (see `write_asset_pack`) rather than from `asset_folder`.
+    tl::optional<std::string> asset_pack = tl::nullopt;
+    // when set, decoded assets are cached in this folder (see `AssetCache`) and reused while their source is unchanged.
+    tl::optional<std::string> asset_cache = tl::nullopt;
+    // reload assets whose files change while the game is running, only supported by folders on Linux.
+    bool watch_for_changes = false;
+    // caps on the loads reading and decoding at the same time, by default decodes are capped at the task pool's thread count.
+    tl::optional<AssetLoadLimits> load_limits = tl::nullopt;
 };
 
 struct AssetPlugin
 {
     void build(GameBuilder& builder)
     {
+        auto hot_reload = false;
         if (!builder.resources().get_resource<AssetServer>().has_value()) {
             auto const settings = [&builder] {
                 if (auto const settings = builder.resources().get_resource<AssetServerSettings>(); settings) {
@@ -24,9 +34,42 @@ struct AssetPlugin
                 }
             }();
 
-            auto asset_io = std::make_unique<FileAssetIo>(settings->asset_folder);
+            // share the game's `TaskPool` instead of spinning up a second set of worker threads
+            auto const task_pool = builder.resources().try_add_resource<TaskPool>();
+
+            auto asset_io = [&settings]() -> std::unique_ptr<AssetIo> {
+                if (settings->asset_pack.has_value()) {
+                    if (auto pack_io = PackAssetIo::open(*settings->asset_pack); pack_io) {
+                        return std::make_unique<PackAssetIo>(*MOV(pack_io));
+                    }
+                    else {
+                        LOG_WARN("Unable to open asset pack '{}': {}, falling back to '{}'.",
+                            *settings->asset_pack, pack_io.error().message(), settings->asset_folder);
+                    }
+                }
+                return std::make_unique<FileAssetIo>(settings->asset_folder);
+            }();
+            auto server = AssetServer(MOV(asset_io), TaskPool(*task_pool));
+            if (settings->asset_cache.has_value()) {
+                if (auto cache = AssetCache::create(*settings->asset_cache); cache) {
+                    server.set_asset_cache(*MOV(cache));
+                }
+                else {
+                    LOG_WARN("Unable to create asset cache '{}': {}, assets will always be decoded.",
+                        *settings->asset_cache, cache.error().message());
+                }
+            }
+            if (settings->load_limits.has_value()) {
+                server.set_load_limits(*settings->load_limits);
+            }
+            if (settings->watch_for_changes) {
+                hot_reload = server.watch_for_changes();
+                if (!hot_reload) {
+                    LOG_WARN("Unable to watch '{}' for changes, assets will not be hot reloaded.", settings->asset_folder);
+                }
+            }
             builder
-                .set_resource<AssetServer>(MOV(asset_io), TaskPool{})
+                .set_resource<AssetServer>(MOV(server))
                 .prepare_components<UntypedHandle>();
         }
 
@@ -34,5 +77,9 @@ struct AssetPlugin
             .add_stage_before<AssetStage::LoadAssets, CoreStages::PreUpdate>()
             .add_stage_after<AssetStage::AssetEvents, CoreStages::PostUpdate>()
             .add_system_to_stage<CoreStages::PreUpdate>(update_asset_ref_count_system);
+
+        if (hot_reload) {
+            builder.add_system_to_stage<AssetStage::LoadAssets>(asset_hot_reload_system);
+        }
     }
 };
\ No newline at end of file
@@ -10,7 +10,7 @@ namespace {
 
     struct UserData
     {
-        std::span<std::byte> bytes;
+        std::span<std::byte const> bytes;
         std::size_t pos = 0;
     };
 
@@ -51,16 +51,10 @@ namespace {
         return bytes_to_read;
     }
 
-    auto write(void const* const ptr, sf_count_t const count, void* const user_data) -> sf_count_t
+    // the bytes may be a read-only mapping of the file, files are only ever opened with `SFM_READ`.
+    auto write(void const* const, sf_count_t const, void* const) -> sf_count_t
     {
-        auto* const ud = static_cast<UserData*>(user_data);
-        auto const buffer_size = ud->bytes.size() - ud->pos;
-        auto const requested_bytes = static_cast<std::size_t>(count);
-
-        auto const bytes_to_write = requested_bytes < buffer_size ? requested_bytes : buffer_size;
-        std::memcpy(static_cast<void*>(ud->bytes.data() + ud->pos), ptr, bytes_to_write);
-        ud->pos += bytes_to_write;
-        return bytes_to_write;
+        return 0;
     }
 
     auto tell(void* const user_data) -> sf_count_t
@@ -79,7 +73,7 @@ struct AudioLoader final : public AssetLoader
         return std::span<std::string_view const>{ exts.data(), exts.size() };
     }
 
-    auto load(std::filesystem::path const&, std::span<std::byte> const bytes) const -> tl::optional<LoadedAsset> final
+    auto load(std::filesystem::path const&, std::span<std::byte const> const bytes) const -> tl::optional<LoadedAsset> final
     {
         auto ud_bytes = bytes;
         auto ud = UserData {
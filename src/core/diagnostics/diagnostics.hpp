@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string_view>
+#include <tl/optional.hpp>
+#include <core/ecs/resource.hpp>
+#include <util/common.hpp>
+#include <util/containers/hash.hpp>
+
+// Timings are only recorded if `ENABLE_DIAGNOSTICS` is defined, otherwise the scheduler hooks compile out.
+// CMake defines it for Debug builds, and for every build type with `-DENABLE_DIAGNOSTICS=ON`.
+
+struct DiagnosticStats
+{
+    using dur_t = std::chrono::duration<float>;
+
+    dur_t min{};
+    dur_t avg{};
+    dur_t p99{};
+    dur_t max{};
+    std::size_t samples = 0;
+};
+
+// Ring buffer of the most recent samples.
+// There can only be a single writer, but any number of readers, none of which ever block.
+template <std::size_t N>
+class SampleRing
+{
+    std::array<std::atomic<float>, N> m_samples{};
+    std::atomic<std::size_t> m_head{ 0 };
+
+public:
+    void push(float const sample) noexcept
+    {
+        auto const head = m_head.load(std::memory_order_relaxed);
+        m_samples[head % N].store(sample, std::memory_order_relaxed);
+        m_head.store(head + 1, std::memory_order_release);
+    }
+
+    [[nodiscard]] auto latest() const noexcept -> tl::optional<float>
+    {
+        auto const head = m_head.load(std::memory_order_acquire);
+        if (head == 0) {
+            return {};
+        }
+        return m_samples[(head - 1) % N].load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] auto stats() const noexcept -> DiagnosticStats
+    {
+        using dur_t = DiagnosticStats::dur_t;
+
+        auto const count = std::min(m_head.load(std::memory_order_acquire), N);
+        if (count == 0) {
+            return DiagnosticStats{};
+        }
+
+        auto samples = std::array<float, N>{};
+        for (std::size_t i = 0; i < count; ++i) {
+            samples[i] = m_samples[i].load(std::memory_order_relaxed);
+        }
+
+        auto const first = samples.begin();
+        auto const last = samples.begin() + count;
+        std::sort(first, last);
+
+        float sum = 0.f;
+        for (auto it = first; it != last; ++it) {
+            sum += *it;
+        }
+
+        auto const p99_index = static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(count))) - 1;
+        return DiagnosticStats{
+            .min = dur_t(*first),
+            .avg = dur_t(sum / static_cast<float>(count)),
+            .p99 = dur_t(samples[p99_index]),
+            .max = dur_t(*(last - 1)),
+            .samples = count,
+        };
+    }
+};
+
+// The rolling wall time of a single system, stage, or frame.
+class Diagnostic
+{
+public:
+    static constexpr std::size_t sample_count = 256;
+
+private:
+    std::string_view m_name;
+    SampleRing<sample_count> m_samples;
+
+public:
+    explicit Diagnostic(std::string_view const name) noexcept
+        : m_name(name)
+    {}
+
+    Diagnostic(Diagnostic const&) = delete;
+    Diagnostic& operator=(Diagnostic const&) = delete;
+
+    [[nodiscard]] auto name() const noexcept -> std::string_view { return m_name; }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> const time) noexcept
+    {
+        m_samples.push(std::chrono::duration_cast<DiagnosticStats::dur_t>(time).count());
+    }
+
+    [[nodiscard]] auto latest() const noexcept -> tl::optional<DiagnosticStats::dur_t>
+    {
+        return m_samples.latest().map([](float const s) { return DiagnosticStats::dur_t(s); });
+    }
+
+    [[nodiscard]] auto stats() const noexcept -> DiagnosticStats
+    {
+        return m_samples.stats();
+    }
+};
+
+// Per system, per stage and whole frame timings, recorded by the `Scheduler` while this resource exists.
+// Entries are only ever added from the main thread in between stages, so reading them from a system is safe.
+class Diagnostics
+{
+    Diagnostic m_frame{ "frame" };
+    HashMap<type_id_t, std::unique_ptr<Diagnostic>> m_stages;
+    HashMap<SystemId, std::unique_ptr<Diagnostic>> m_systems;
+
+public:
+    [[nodiscard]] auto frame() noexcept -> Diagnostic& { return m_frame; }
+    [[nodiscard]] auto frame() const noexcept -> Diagnostic const& { return m_frame; }
+
+    auto register_stage(type_id_t const id) -> Diagnostic&
+    {
+        auto const [iter, inserted] = m_stages.try_emplace(id);
+        if (inserted) {
+            iter->second = std::make_unique<Diagnostic>(id.name());
+        }
+        return *iter->second;
+    }
+
+    auto register_system(SystemId const id) -> Diagnostic&
+    {
+        auto const [iter, inserted] = m_systems.try_emplace(id);
+        if (inserted) {
+            iter->second = std::make_unique<Diagnostic>(id.id.name());
+        }
+        return *iter->second;
+    }
+
+    [[nodiscard]] auto stage(type_id_t const id) const -> tl::optional<Diagnostic const&>
+    {
+        if (auto const iter = m_stages.find(id); iter != m_stages.end()) {
+            return tl::optional<Diagnostic const&>(*iter->second);
+        }
+        return {};
+    }
+
+    template <typename StageTag>
+    [[nodiscard]] auto stage() const -> tl::optional<Diagnostic const&>
+    {
+        return stage(type_id<std::remove_cvref_t<StageTag>>());
+    }
+
+    [[nodiscard]] auto system(SystemId const id) const -> tl::optional<Diagnostic const&>
+    {
+        if (auto const iter = m_systems.find(id); iter != m_systems.end()) {
+            return tl::optional<Diagnostic const&>(*iter->second);
+        }
+        return {};
+    }
+
+    // invokes `f(Diagnostic const&)` for every system.
+    template <typename F>
+    void for_each_system(F&& f) const
+    {
+        for (auto const& [id, diagnostic] : m_systems) {
+            f(std::as_const(*diagnostic));
+        }
+    }
+
+    // invokes `f(Diagnostic const&)` for every stage.
+    template <typename F>
+    void for_each_stage(F&& f) const
+    {
+        for (auto const& [id, diagnostic] : m_stages) {
+            f(std::as_const(*diagnostic));
+        }
+    }
+};
+
+// Records the time from construction to destruction into a `Diagnostic`, does nothing if there is none.
+class DiagnosticTimer
+{
+    using clock_t = std::chrono::steady_clock;
+
+    Diagnostic* m_target;
+    clock_t::time_point m_start;
+
+public:
+    explicit DiagnosticTimer(Diagnostic* const target) noexcept
+        : m_target(target)
+        , m_start(target ? clock_t::now() : clock_t::time_point{})
+    {}
+
+    DiagnosticTimer(DiagnosticTimer const&) = delete;
+    DiagnosticTimer& operator=(DiagnosticTimer const&) = delete;
+
+    ~DiagnosticTimer()
+    {
+        if (m_target) {
+            m_target->record(clock_t::now() - m_start);
+        }
+    }
+};
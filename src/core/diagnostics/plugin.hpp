@@ -0,0 +1,55 @@
+#pragma once
+
+#include <core/game/game.hpp>
+#include <core/input/input.hpp>
+#include <core/input/keyboard.hpp>
+#include <tl/optional.hpp>
+#include "diagnostics.hpp"
+#include "trace.hpp"
+
+// Captures `frames` frames into `path` whenever `key` is pressed.
+struct TraceCaptureBinding
+{
+    KeyCode key = KeyCode::F12;
+    std::size_t frames = 60;
+    std::filesystem::path path = "trace.json";
+};
+
+inline void trace_capture_binding_system(
+    Resource<Input<KeyCode> const> input,
+    Resource<TraceCaptureBinding const> binding,
+    Resource<TraceCapture> capture)
+{
+    if (input->just_pressed(binding->key) && !capture->is_capturing()) {
+        capture->capture(binding->frames, binding->path);
+    }
+}
+
+// Adds the `Diagnostics` resource, which makes the scheduler start recording timings.
+struct DiagnosticsPlugin
+{
+    void build(GameBuilder& builder) const
+    {
+        builder.try_add_resource<Diagnostics>();
+    }
+};
+
+// Adds the `TraceCapture` resource, use `TraceCapture::capture()` to write the spans of the next frames to a trace file.
+// If `binding` is set and an `Input<KeyCode>` resource exists, pressing the key starts a capture as well.
+struct TracePlugin
+{
+    tl::optional<TraceCaptureBinding> binding = TraceCaptureBinding{};
+
+    void build(GameBuilder& builder) const
+    {
+        builder
+            .try_add_resource<TraceCapture>()
+            .add_system_to_stage<CoreStages::PreEvents>(trace_capture_system);
+
+        if (binding && builder.resources().contains_resource<Input<KeyCode>>()) {
+            builder
+                .set_resource<TraceCaptureBinding>(*binding)
+                .add_system_to_stage<CoreStages::PreUpdate>(trace_capture_binding_system);
+        }
+    }
+};
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <fmt/format.h>
+#include <core/ecs/resource.hpp>
+#include <debug/debug.hpp>
+#include <util/common.hpp>
+#include "diagnostics.hpp"
+
+// A single complete span, `name` and `category` must outlive the capture (e.g. literals or `type_name<T>()`).
+struct TraceEvent
+{
+    using clock_t = std::chrono::steady_clock;
+
+    std::string_view name;
+    std::string_view category;
+    clock_t::time_point begin;
+    clock_t::time_point end;
+    std::uint32_t thread = 0;
+};
+
+namespace trace_detail {
+
+    // Fixed capacity event buffer owned by a single thread. Once full, further events are dropped
+    // so that capturing never allocates or takes a lock on the recording thread.
+    class ThreadTraceBuffer
+    {
+    public:
+        static constexpr std::size_t capacity = 1 << 15;
+
+    private:
+        std::unique_ptr<std::array<TraceEvent, capacity>> m_events;
+        std::atomic<std::size_t> m_size{ 0 };
+        std::atomic<std::size_t> m_epoch{ 0 };
+        std::atomic<std::size_t> m_dropped{ 0 };
+        std::uint32_t m_thread;
+
+    public:
+        explicit ThreadTraceBuffer(std::uint32_t const thread) noexcept
+            : m_thread(thread)
+        {}
+
+        [[nodiscard]] auto thread() const noexcept -> std::uint32_t { return m_thread; }
+
+        // only called by the owning thread.
+        void push(std::size_t const epoch, TraceEvent event)
+        {
+            if (m_epoch.load(std::memory_order_relaxed) != epoch) { // first event of a new capture
+                if (!m_events) {
+                    m_events = std::make_unique<std::array<TraceEvent, capacity>>();
+                }
+                m_size.store(0, std::memory_order_relaxed);
+                m_dropped.store(0, std::memory_order_relaxed);
+                m_epoch.store(epoch, std::memory_order_release);
+            }
+
+            auto const size = m_size.load(std::memory_order_relaxed);
+            if (size == capacity) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            event.thread = m_thread;
+            (*m_events)[size] = event;
+            m_size.store(size + 1, std::memory_order_release);
+        }
+
+        // copies every event recorded during `epoch`, returns the amount of dropped events.
+        auto collect(std::size_t const epoch, std::vector<TraceEvent>& out) const -> std::size_t
+        {
+            if (m_epoch.load(std::memory_order_acquire) != epoch) {
+                return 0;
+            }
+
+            auto const size = m_size.load(std::memory_order_acquire);
+            out.insert(out.end(), m_events->begin(), m_events->begin() + size);
+            return m_dropped.load(std::memory_order_relaxed);
+        }
+    };
+
+} // namespace trace_detail
+
+// Process wide recorder for `TRACE_SCOPE` spans.
+// While no capture is running, recording a span costs a single relaxed atomic load.
+class Tracer
+{
+    std::atomic<bool> m_capturing{ false };
+    std::atomic<std::size_t> m_epoch{ 0 };
+    TraceEvent::clock_t::time_point m_capture_start;
+
+    std::mutex m_buffers_mutex;
+    std::vector<std::shared_ptr<trace_detail::ThreadTraceBuffer>> m_buffers;
+
+    Tracer() = default;
+
+    auto thread_buffer() -> trace_detail::ThreadTraceBuffer&
+    {
+        thread_local auto const buffer = [this] {
+            auto const lock = std::scoped_lock(m_buffers_mutex);
+            auto const thread = static_cast<std::uint32_t>(m_buffers.size());
+            return m_buffers.emplace_back(std::make_shared<trace_detail::ThreadTraceBuffer>(thread));
+        }();
+        return *buffer;
+    }
+
+public:
+    struct Capture
+    {
+        std::vector<TraceEvent> events;
+        TraceEvent::clock_t::time_point start;
+        std::size_t dropped = 0;
+    };
+
+    Tracer(Tracer const&) = delete;
+    Tracer& operator=(Tracer const&) = delete;
+
+    [[nodiscard]] static auto instance() -> Tracer&
+    {
+        static auto tracer = Tracer{};
+        return tracer;
+    }
+
+    [[nodiscard]] auto is_capturing() const noexcept -> bool
+    {
+        return m_capturing.load(std::memory_order_relaxed);
+    }
+
+    void begin_capture()
+    {
+        m_capture_start = TraceEvent::clock_t::now();
+        m_epoch.fetch_add(1, std::memory_order_relaxed);
+        m_capturing.store(true, std::memory_order_release);
+    }
+
+    // stops capturing and returns every span that was recorded since `begin_capture()`.
+    auto end_capture() -> Capture
+    {
+        m_capturing.store(false, std::memory_order_release);
+
+        auto capture = Capture{ .start = m_capture_start };
+        auto const epoch = m_epoch.load(std::memory_order_relaxed);
+
+        auto const lock = std::scoped_lock(m_buffers_mutex);
+        for (auto const& buffer : m_buffers) {
+            capture.dropped += buffer->collect(epoch, capture.events);
+        }
+        return capture;
+    }
+
+    void record(TraceEvent const& event)
+    {
+        if (!is_capturing()) {
+            return;
+        }
+        thread_buffer().push(m_epoch.load(std::memory_order_relaxed), event);
+    }
+};
+
+// Records the span from construction to destruction while a capture is running.
+class TraceScope
+{
+    std::string_view m_name;
+    std::string_view m_category;
+    TraceEvent::clock_t::time_point m_begin;
+    bool m_active;
+
+public:
+    TraceScope(std::string_view const name, std::string_view const category) noexcept
+        : m_name(name)
+        , m_category(category)
+        , m_active(Tracer::instance().is_capturing())
+    {
+        if (m_active) {
+            m_begin = TraceEvent::clock_t::now();
+        }
+    }
+
+    TraceScope(TraceScope const&) = delete;
+    TraceScope& operator=(TraceScope const&) = delete;
+
+    ~TraceScope()
+    {
+        if (m_active) {
+            Tracer::instance().record(TraceEvent{
+                .name = m_name,
+                .category = m_category,
+                .begin = m_begin,
+                .end = TraceEvent::clock_t::now(),
+                });
+        }
+    }
+};
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#ifdef ENABLE_DIAGNOSTICS
+    #define TRACE_SCOPE(name, category) auto const TRACE_CONCAT(trace_scope_, __LINE__) = TraceScope(name, category)
+#else
+    #define TRACE_SCOPE(name, category)
+#endif
+
+namespace trace_detail {
+
+    inline void write_json_string(std::string& out, std::string_view const str)
+    {
+        out.push_back('"');
+        for (auto const c : str) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                default: out.push_back(c); break;
+            }
+        }
+        out.push_back('"');
+    }
+
+} // namespace trace_detail
+
+// Serializes a capture in the chrome trace event format, which can be opened in `chrome://tracing` or Perfetto.
+[[nodiscard]] inline auto trace_to_json(Tracer::Capture const& capture) -> std::string
+{
+    using us_t = std::chrono::duration<double, std::micro>;
+
+    auto out = std::string{};
+    out += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    for (auto const& event : capture.events) {
+        if (!first) {
+            out.push_back(',');
+        }
+        first = false;
+
+        out += "{\"name\":";
+        trace_detail::write_json_string(out, event.name);
+        out += ",\"cat\":";
+        trace_detail::write_json_string(out, event.category);
+        fmt::format_to(std::back_inserter(out),
+            ",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":0,\"tid\":{}}}",
+            us_t(event.begin - capture.start).count(),
+            us_t(event.end - event.begin).count(),
+            event.thread);
+    }
+
+    out += "]}";
+    return out;
+}
+
+// Request a capture of the next `frames` frames by calling `capture()`.
+// The trace is written to `path` once the frames have run.
+class TraceCapture
+{
+    std::filesystem::path m_path = "trace.json";
+    std::size_t m_requested_frames = 0;
+    std::size_t m_remaining_frames = 0;
+
+    friend void trace_capture_system(Resource<TraceCapture>);
+
+public:
+    void capture(std::size_t const frames, std::filesystem::path path = "trace.json")
+    {
+        m_requested_frames = frames;
+        m_path = MOV(path);
+    }
+
+    [[nodiscard]] auto is_capturing() const noexcept -> bool
+    {
+        return m_remaining_frames > 0;
+    }
+
+    [[nodiscard]] auto path() const noexcept -> std::filesystem::path const& { return m_path; }
+};
+
+// Starts and stops the `Tracer` on frame boundaries, should run in the first stage of the frame.
+inline void trace_capture_system(Resource<TraceCapture> capture)
+{
+    auto& tracer = Tracer::instance();
+
+    if (capture->m_remaining_frames > 0 && --capture->m_remaining_frames == 0) {
+        auto const result = tracer.end_capture();
+        if (result.dropped > 0) {
+            LOG_WARN("Trace capture dropped {} events, consider capturing fewer frames.", result.dropped);
+        }
+
+        auto file = std::ofstream(capture->m_path, std::ios::binary);
+        if (!file) {
+            LOG_ERROR("Unable to write trace capture to: '{}'", capture->m_path.string());
+            return;
+        }
+        auto const json = trace_to_json(result);
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        LOG_INFO("Wrote trace capture to: '{}'", capture->m_path.string());
+    }
+
+    if (capture->m_requested_frames > 0 && capture->m_remaining_frames == 0) {
+        capture->m_remaining_frames = std::exchange(capture->m_requested_frames, 0);
+        tracer.begin_capture();
+    }
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include <core/game/events.hpp>
+#include <core/game/parallel_events.hpp>
+#include <util/common.hpp>
+#include <util/meta.hpp>
+#include "query.hpp"
+#include "resource.hpp"
+
+// The data a system reads and writes, derived from its parameter list.
+class SystemAccess
+{
+    std::vector<type_id_t> m_resource_reads;
+    std::vector<type_id_t> m_resource_writes;
+    std::vector<type_id_t> m_component_reads;
+    std::vector<type_id_t> m_component_writes;
+    bool m_exclusive = false;
+    bool m_main_thread = false;
+
+    static void add_unique(std::vector<type_id_t>& ids, type_id_t const id)
+    {
+        if (std::ranges::find(ids, id) == ids.end()) {
+            ids.push_back(id);
+        }
+    }
+
+    static auto intersects(std::vector<type_id_t> const& lhs, std::vector<type_id_t> const& rhs) noexcept -> bool
+    {
+        return std::ranges::any_of(lhs, [&rhs](type_id_t const& id) { return std::ranges::find(rhs, id) != rhs.end(); });
+    }
+
+public:
+    template <typename T>
+    void add_resource_read()
+    {
+        add_unique(m_resource_reads, type_id<std::remove_cvref_t<T>>());
+        m_main_thread |= is_main_thread_resource<std::remove_cvref_t<T>>::value;
+    }
+
+    template <typename T>
+    void add_resource_write()
+    {
+        add_unique(m_resource_writes, type_id<std::remove_cvref_t<T>>());
+        m_main_thread |= is_main_thread_resource<std::remove_cvref_t<T>>::value;
+    }
+
+    template <typename T>
+    void add_component_read()
+    {
+        add_unique(m_component_reads, type_id<std::remove_cvref_t<T>>());
+    }
+
+    template <typename T>
+    void add_component_write()
+    {
+        add_unique(m_component_writes, type_id<std::remove_cvref_t<T>>());
+    }
+
+    // exclusive systems may structurally modify the `World` or `Resources` and therefore conflict with every other system.
+    void set_exclusive() noexcept { m_exclusive = true; }
+    void set_main_thread() noexcept { m_main_thread = true; }
+
+    [[nodiscard]] auto is_exclusive() const noexcept -> bool { return m_exclusive; }
+    [[nodiscard]] auto is_main_thread() const noexcept -> bool { return m_main_thread; }
+
+    [[nodiscard]] auto resource_reads() const noexcept -> std::vector<type_id_t> const& { return m_resource_reads; }
+    [[nodiscard]] auto resource_writes() const noexcept -> std::vector<type_id_t> const& { return m_resource_writes; }
+    [[nodiscard]] auto component_reads() const noexcept -> std::vector<type_id_t> const& { return m_component_reads; }
+    [[nodiscard]] auto component_writes() const noexcept -> std::vector<type_id_t> const& { return m_component_writes; }
+
+    // two systems conflict if either writes something the other one reads or writes.
+    [[nodiscard]] auto conflicts_with(SystemAccess const& other) const noexcept -> bool
+    {
+        if (m_exclusive || other.m_exclusive) {
+            return true;
+        }
+
+        return intersects(m_resource_writes, other.m_resource_writes)
+            || intersects(m_resource_writes, other.m_resource_reads)
+            || intersects(m_resource_reads, other.m_resource_writes)
+            || intersects(m_component_writes, other.m_component_writes)
+            || intersects(m_component_writes, other.m_component_reads)
+            || intersects(m_component_reads, other.m_component_writes);
+    }
+};
+
+namespace internal {
+
+    // Describes the access of a single system argument.
+    template <typename Arg>
+    struct system_param_access
+    {
+        static void add(SystemAccess&) {}
+    };
+
+    template <typename VG, typename... Ws, typename... WOs>
+    struct system_param_access<Query<With<Ws...>, Without<WOs...>, VG>>
+    {
+        template <typename W>
+        static void add_with(SystemAccess& access)
+        {
+            // change filters only read the ticks that are written alongside their component.
+            if constexpr (is_change_filter<W>::value) {
+                access.add_component_read<typename W::component_t>();
+            }
+            // groups own (and reorder) their storage so they always count as a write.
+            else if constexpr (std::is_const_v<W> && !std::is_same_v<VG, Group>) {
+                access.add_component_read<W>();
+            }
+            else {
+                access.add_component_write<W>();
+            }
+        }
+
+        static void add(SystemAccess& access)
+        {
+            (add_with<Ws>(access), ...);
+            (access.add_component_read<WOs>(), ...);
+        }
+    };
+
+    template <typename R>
+    struct system_param_access<Resource<R>>
+    {
+        static void add(SystemAccess& access)
+        {
+            if constexpr (std::is_const_v<R>) {
+                access.add_resource_read<R>();
+            }
+            else {
+                access.add_resource_write<R>();
+            }
+        }
+    };
+
+    template <typename T>
+    struct system_param_access<EventReader<T>>
+    {
+        static void add(SystemAccess& access)
+        {
+            access.add_resource_read<Events<T>>();
+        }
+    };
+
+    // writers append to their own lane, only the flush at the end of the frame writes the resource itself.
+    template <typename T>
+    struct system_param_access<ParallelEventWriter<T>>
+    {
+        static void add(SystemAccess& access)
+        {
+            access.add_resource_read<ParallelEvents<T>>();
+        }
+    };
+
+    template <typename... Args>
+    auto make_system_access(meta::args<Args...>) -> SystemAccess
+    {
+        auto access = SystemAccess{};
+        (system_param_access<std::remove_cvref_t<Args>>::add(access), ...);
+        return access;
+    }
+
+} // namespace internal
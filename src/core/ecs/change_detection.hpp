@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "world.hpp"
+
+using tick_t = std::uint64_t;
+
+// World wide change tick, it is advanced every time a system runs and every time a component is stamped.
+// Every stamp is newer than the tick of any system that already started, so a change is seen by every system
+// that runs after it, no matter if it was made by a system, by `Commands` at the end of a stage or outside of the schedule.
+class ChangeTick
+{
+    std::atomic<tick_t> m_tick{ 1 };
+
+public:
+    ChangeTick() noexcept = default;
+    ChangeTick(ChangeTick const&) = delete;
+    ChangeTick& operator=(ChangeTick const&) = delete;
+
+    [[nodiscard]] auto current() const noexcept -> tick_t
+    {
+        return m_tick.load(std::memory_order_relaxed);
+    }
+
+    // returns the new tick.
+    auto advance() noexcept -> tick_t
+    {
+        return m_tick.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+};
+
+// Stored next to every `T` once changes of `T` are tracked (see `track_changes<T>()`).
+template <typename T>
+struct ComponentTicks
+{
+    tick_t added = 0;
+    tick_t changed = 0;
+};
+
+// Query filter, matches entities whose `T` was added since the system last ran.
+template <typename T>
+struct Added
+{
+    using component_t = T;
+
+    [[nodiscard]] static constexpr auto matches(ComponentTicks<T> const& ticks, tick_t const last_run) noexcept -> bool
+    {
+        return ticks.added > last_run;
+    }
+};
+
+// Query filter, matches entities whose `T` was added or changed since the system last ran.
+// Writing through a component reference is not tracked, use `Commands::mark_changed<T>()` (or `World::patch<T>()`).
+template <typename T>
+struct Changed
+{
+    using component_t = T;
+
+    [[nodiscard]] static constexpr auto matches(ComponentTicks<T> const& ticks, tick_t const last_run) noexcept -> bool
+    {
+        return ticks.changed > last_run;
+    }
+};
+
+template <typename T>
+struct is_change_filter : std::false_type {};
+
+template <typename T>
+struct is_change_filter<Added<T>> : std::true_type {};
+
+template <typename T>
+struct is_change_filter<Changed<T>> : std::true_type {};
+
+namespace change_detail {
+
+    template <typename T>
+    void on_construct(ChangeTick& tick, World& world, entity_t const e)
+    {
+        auto const now = tick.advance();
+        world.emplace_or_replace<ComponentTicks<T>>(e, now, now);
+    }
+
+    template <typename T>
+    void on_update(ChangeTick& tick, World& world, entity_t const e)
+    {
+        world.get<ComponentTicks<T>>(e).changed = tick.advance();
+    }
+
+    template <typename T>
+    void on_destroy(World& world, entity_t const e)
+    {
+        world.remove<ComponentTicks<T>>(e);
+    }
+
+} // namespace change_detail
+
+// Starts stamping `T` with `ComponentTicks<T>` whenever it is added, patched or replaced.
+// Existing components are treated as if they were added now. Connecting the same world twice is a no-op.
+template <typename T>
+void track_changes(World& world, ChangeTick& tick)
+{
+    using component_t = std::remove_const_t<T>;
+
+    world.on_construct<component_t>().template connect<&change_detail::on_construct<component_t>>(tick);
+    world.on_update<component_t>().template connect<&change_detail::on_update<component_t>>(tick);
+    world.on_destroy<component_t>().template connect<&change_detail::on_destroy<component_t>>();
+
+    auto const untracked = world.view<component_t const>(entt::exclude<ComponentTicks<component_t>>);
+    auto const now = tick.advance();
+    for (auto const e : std::vector<entity_t>(untracked.begin(), untracked.end())) {
+        world.emplace<ComponentTicks<component_t>>(e, now, now);
+    }
+}
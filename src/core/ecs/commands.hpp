@@ -1,5 +1,14 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include <debug/debug.hpp>
 #include "util/common.hpp"
 #include "resource.hpp"
 #include "world.hpp"
@@ -10,97 +19,259 @@ concept Bundle = requires(T && bundle, World & world)
     { FWD(bundle).build(world) };
 };
 
-// TODO:
-//     Lazy commands??
-//     vector<unique_ptr<Command>>
-class Commands {
-    Resources* m_resources;
-    World* m_world;
-    entity_t m_curr_entity = null_entity;
+// A bundle that can insert the components of many entities at once, one component pool at a time.
+template <typename T>
+concept BatchBundle = Bundle<T> && requires(World & world, std::span<entity_t const> entities, std::span<T> bundles)
+{
+    { T::build_batch(world, entities, bundles) };
+};
+
+// Spawns an entity for every bundle. `BatchBundle`s are inserted in bulk, other bundles are built one by one.
+template <Bundle B>
+void spawn_batch(World& world, std::span<B> const bundles)
+{
+    if constexpr (BatchBundle<B>) {
+        auto entities = std::vector<entity_t>(bundles.size());
+        world.create(entities.begin(), entities.end());
+        B::build_batch(world, entities, bundles);
+    }
+    else {
+        for (auto& bundle : bundles) {
+            MOV(bundle).build(world);
+        }
+    }
+}
+
+namespace commands_detail {
+
+    // State shared by the commands of a single queue while they are applied.
+    struct CommandContext
+    {
+        Resources& resources;
+        World& world;
+        entity_t current_entity = null_entity;
+    };
+
+    // Bump allocator made out of fixed size blocks.
+    // Blocks are kept around on `reset()`, so a warmed up arena no longer allocates.
+    class CommandArena
+    {
+        static constexpr std::size_t block_size = 16 * 1024;
+
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size = 0;
+        };
+
+        std::vector<Block> m_blocks;
+        std::size_t m_block = 0;
+        std::size_t m_offset = 0;
+
+    public:
+        [[nodiscard]] auto allocate(std::size_t const size, std::size_t const align) -> void*
+        {
+            for (; m_block < m_blocks.size(); ++m_block, m_offset = 0) {
+                auto& block = m_blocks[m_block];
+                auto const start = (m_offset + align - 1) & ~(align - 1);
+                if (start + size <= block.size) {
+                    m_offset = start + size;
+                    return block.data.get() + start;
+                }
+            }
+
+            auto const new_size = std::max(block_size, size);
+            auto& block = m_blocks.emplace_back(Block{ std::unique_ptr<std::byte[]>(new std::byte[new_size]), new_size });
+            m_offset = size;
+            return block.data.get();
+        }
+
+        void reset() noexcept
+        {
+            m_block = 0;
+            m_offset = 0;
+        }
+    };
+
+} // namespace commands_detail
+
+// Type erased list of deferred `World` and `Resources` mutations.
+// Every system owns its own queue, which is applied by its `Stage` once all systems of the stage have run.
+class CommandQueue
+{
+    using context_t = commands_detail::CommandContext;
+
+    struct Command
+    {
+        void* data;
+        void(*apply)(void*, context_t&);
+        void(*destroy)(void*) noexcept;
+    };
+
+    commands_detail::CommandArena m_arena;
+    std::vector<Command> m_commands;
 
 public:
+    CommandQueue() = default;
+    CommandQueue(CommandQueue const&) = delete;
+    CommandQueue& operator=(CommandQueue const&) = delete;
 
-    constexpr Commands(Resources& resources, World& world) noexcept
-        : m_resources(&resources)
-        , m_world(&world)
+    ~CommandQueue() { clear(); }
+
+    template <typename F>
+    requires (std::is_invocable_v<std::decay_t<F>&, context_t&>)
+    void push(F&& f)
     {
+        using command_t = std::decay_t<F>;
+        static_assert(alignof(command_t) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Over aligned commands are not supported");
+
+        auto const data = ::new (m_arena.allocate(sizeof(command_t), alignof(command_t))) command_t(FWD(f));
+        m_commands.push_back(Command{
+            .data = data,
+            .apply = [](void* const ptr, context_t& ctx) { (*static_cast<command_t*>(ptr))(ctx); },
+            .destroy = [](void* const ptr) noexcept { static_cast<command_t*>(ptr)->~command_t(); },
+            });
     }
 
+    // applies every command in the order they were pushed, and then clears the queue.
+    void apply(Resources& resources, World& world)
+    {
+        auto ctx = context_t{ .resources = resources, .world = world };
+        for (auto const& command : m_commands) {
+            command.apply(command.data, ctx);
+        }
+        clear();
+    }
+
+    void clear() noexcept
+    {
+        for (auto const& command : m_commands) {
+            command.destroy(command.data);
+        }
+        m_commands.clear();
+        m_arena.reset();
+    }
+
+    [[nodiscard]] auto size() const noexcept -> std::size_t { return m_commands.size(); }
+    [[nodiscard]] auto empty() const noexcept -> bool { return m_commands.empty(); }
+};
+
+// Records mutations into the `CommandQueue` of the system it was given to.
+// Nothing is applied until the end of the system's stage.
+class Commands {
+    using context_t = commands_detail::CommandContext;
+
+    CommandQueue* m_queue;
+
+public:
+    constexpr explicit Commands(CommandQueue& queue) noexcept
+        : m_queue(std::addressof(queue))
+    {}
+
     constexpr Commands(Commands&&) noexcept = default;
     constexpr Commands(Commands const&) noexcept = default;
     constexpr Commands& operator=(Commands&&) noexcept = default;
     constexpr Commands& operator=(Commands const&) noexcept = default;
 
-    auto spawn(entity_t* const e = nullptr) -> Commands&
+    // spawns an entity and makes it the current entity for following commands.
+    auto spawn() -> Commands&
     {
-        auto const entity = m_world->create();
-        m_curr_entity = entity;
-        if (e) {
-            *e = entity;
-        }
+        m_queue->push([](context_t& ctx) { ctx.current_entity = ctx.world.create(); });
         return *this;
     }
 
     template <Bundle B>
     auto spawn(B&& bundle) -> Commands&
     {
-        FWD(bundle).build(*m_world);
+        m_queue->push([bundle = FWD(bundle)](context_t& ctx) mutable { MOV(bundle).build(ctx.world); });
         return *this;
     }
 
-    auto set_current_entity(entity_t const e) -> Commands&
+    // spawns an entity for every bundle in `bundles`, see `spawn_batch()`.
+    template <std::ranges::input_range R>
+    requires (Bundle<std::ranges::range_value_t<R>>)
+    auto spawn_batch(R&& bundles) -> Commands&
     {
-        m_curr_entity = e;
+        using bundle_t = std::ranges::range_value_t<R>;
+
+        auto batch = std::vector<bundle_t>{};
+        if constexpr (std::is_same_v<std::remove_cvref_t<R>, std::vector<bundle_t>> && !std::is_lvalue_reference_v<R>) {
+            batch = MOV(bundles);
+        }
+        else {
+            if constexpr (std::ranges::sized_range<R>) {
+                batch.reserve(std::ranges::size(bundles));
+            }
+            for (auto&& bundle : bundles) {
+                batch.push_back(FWD(bundle));
+            }
+        }
+
+        m_queue->push([batch = MOV(batch)](context_t& ctx) mutable { ::spawn_batch(ctx.world, std::span<bundle_t>(batch)); });
         return *this;
     }
 
-    auto current_entity() const noexcept -> entity_t
+    auto set_current_entity(entity_t const e) -> Commands&
     {
-        return m_curr_entity;
+        m_queue->push([e](context_t& ctx) { ctx.current_entity = e; });
+        return *this;
     }
 
     auto despawn(entity_t const e) -> Commands&
     {
-        m_world->destroy(e);
+        m_queue->push([e](context_t& ctx) { ctx.world.destroy(e); });
         return *this;
     }
 
     auto clear_entities() -> Commands&
     {
-        m_world->clear();
+        m_queue->push([](context_t& ctx) { ctx.world.clear(); });
         return *this;
     }
 
     template <typename T, typename... Args>
     auto add_component(Args&&... args) -> Commands&
     {
-        DEBUG_ASSERT(null_entity != m_curr_entity, "`Commands` does not contain a valid entity. Consider using `spawn()` to set one.");
-        m_world->emplace<T>(m_curr_entity, FWD(args)...);
+        m_queue->push([... args = FWD(args)](context_t& ctx) mutable {
+            DEBUG_ASSERT(null_entity != ctx.current_entity, "`Commands` does not contain a valid entity. Consider using `spawn()` to set one.");
+            ctx.world.emplace<T>(ctx.current_entity, MOV(args)...);
+        });
         return *this;
     }
 
     template <typename... Cs>
     auto remove_components() -> Commands&
     {
-        m_world->remove<Cs...>(m_curr_entity);
+        m_queue->push([](context_t& ctx) { ctx.world.remove<Cs...>(ctx.current_entity); });
+        return *this;
+    }
+
+    // stamps `e`'s `T` as changed, so that it is matched by `Changed<T>` filters.
+    template <typename T>
+    auto mark_changed(entity_t const e) -> Commands&
+    {
+        m_queue->push([e](context_t& ctx) { ctx.world.patch<T>(e); });
         return *this;
     }
 
     template <typename R, typename... Args>
-    auto try_add_resource(Args&&... args) -> Resource<R>
+    auto try_add_resource(Args&&... args) -> Commands&
     {
-        return m_resources->try_add_resource<R>(FWD(args)...);
+        m_queue->push([... args = FWD(args)](context_t& ctx) mutable { ctx.resources.try_add_resource<R>(MOV(args)...); });
+        return *this;
     }
 
     template <typename R, typename... Args>
-    auto set_resource(Args&&... args) -> Resource<R>
+    auto set_resource(Args&&... args) -> Commands&
     {
-        return m_resources->set_resource<R>(FWD(args)...);
+        m_queue->push([... args = FWD(args)](context_t& ctx) mutable { ctx.resources.set_resource<R>(MOV(args)...); });
+        return *this;
     }
 
     template <typename R>
-    auto remove_resource() -> std::unique_ptr<R>
+    auto remove_resource() -> Commands&
     {
-        return m_resources->remove_resource<R>();
+        m_queue->push([](context_t& ctx) { ctx.resources.remove_resource<R>(); });
+        return *this;
     }
-};
\ No newline at end of file
+};
@@ -1,5 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <core/task/task_pool.hpp>
+#include <debug/debug.hpp>
+#include <util/common.hpp>
+#include "change_detection.hpp"
+#include "world.hpp"
+
 template <typename... Cs>
 struct With {};
 
@@ -12,38 +25,225 @@ struct Group {};
 template <typename W, typename WO = Without<>, typename VG = View>
 struct Query;
 
-template <typename... Ws, typename... WOs>
-class Query<With<Ws...>, Without<WOs...>, View>
-{
-    using base_t = entt::view<entt::exclude_t<WOs...>, Ws...>;
-    base_t m_repr;
+namespace query_detail {
 
-public:
-    template <typename T>
-    requires (!std::is_same_v<std::remove_cvref_t<T>, Query>)
-        constexpr Query(T&& repr) noexcept : m_repr(FWD(repr)) {}
+    template <typename F, typename Tuple>
+    struct is_const_applicable : std::false_type {};
 
-    auto begin() { return m_repr.begin(); }
-    auto end() { return m_repr.end(); }
+    template <typename F, typename... Ts>
+    struct is_const_applicable<F, std::tuple<Ts...>> : std::is_invocable<F const&, Ts...> {};
 
-    template <typename F>
-    void each(F&& f) { m_repr.each(FWD(f)); }
-};
+    // `With<>` may contain both components and change filters (e.g. `With<Transform const, Changed<Transform>>`).
+    template <typename W>
+    using component_part_t = std::conditional_t<is_change_filter<W>::value, std::tuple<>, std::tuple<W>>;
+
+    template <typename W>
+    using filter_part_t = std::conditional_t<is_change_filter<W>::value, std::tuple<W>, std::tuple<>>;
+
+    template <typename... Ws>
+    using components_t = decltype(std::tuple_cat(std::declval<component_part_t<Ws>>()...));
+
+    template <typename... Ws>
+    using filters_t = decltype(std::tuple_cat(std::declval<filter_part_t<Ws>>()...));
+
+    template <typename Components, typename Filters, typename WO, typename VG>
+    struct repr;
+
+    // The `ComponentTicks` of every filter are part of the view, so they always come after the fetched components.
+    template <typename... Cs, typename... Fs, typename... WOs>
+    struct repr<std::tuple<Cs...>, std::tuple<Fs...>, Without<WOs...>, View>
+    {
+        using type = entt::view<entt::exclude_t<WOs...>, Cs..., ComponentTicks<typename Fs::component_t> const...>;
+
+        // the packed entities of the view's leading storage, only those the view `contains` match.
+        static constexpr bool packed_is_exact = false;
+
+        static auto create(World& world) -> type
+        {
+            return world.view<Cs..., ComponentTicks<typename Fs::component_t> const...>(entt::exclude<WOs...>);
+        }
+
+        static auto packed(type const& view) -> std::span<entity_t const>
+        {
+            auto const& storage = view.handle();
+            return { storage.data(), storage.size() };
+        }
+    };
+
+    template <typename... Cs, typename... Fs, typename... WOs>
+    struct repr<std::tuple<Cs...>, std::tuple<Fs...>, Without<WOs...>, Group>
+    {
+        using type = entt::group<entt::exclude_t<WOs...>, entt::get_t<ComponentTicks<typename Fs::component_t> const...>, Cs...>;
+
+        // a group keeps exactly its entities packed together.
+        static constexpr bool packed_is_exact = true;
+
+        static auto create(World& world) -> type
+        {
+            return world.group<Cs...>(entt::get<ComponentTicks<typename Fs::component_t> const...>, entt::exclude<WOs...>);
+        }
+
+        static auto packed(type const& group) -> std::span<entity_t const>
+        {
+            return { group.data(), group.size() };
+        }
+    };
+
+    template <typename Filters>
+    class ChangeFilter;
 
-template <typename... Ws, typename... WOs>
-class Query<With<Ws...>, Without<WOs...>, Group>
+    template <typename... Fs>
+    class ChangeFilter<std::tuple<Fs...>>
+    {
+        tick_t m_last_run = 0;
+
+    public:
+        static constexpr bool enabled = sizeof...(Fs) > 0;
+
+        constexpr explicit ChangeFilter(tick_t const last_run = 0) noexcept
+            : m_last_run(last_run)
+        {}
+
+        // `all` is everything the view yields for one entity: the fetched components followed by the filters' ticks.
+        template <typename Tuple>
+        [[nodiscard]] auto matches(Tuple const& all) const noexcept -> bool
+        {
+            constexpr auto offset = std::tuple_size_v<Tuple> - sizeof...(Fs);
+            return[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                return (Fs::matches(std::get<offset + Is>(all), m_last_run) && ...);
+            }(std::index_sequence_for<Fs...>{});
+        }
+
+        // strips the filters' ticks from what the view yields.
+        template <typename Tuple>
+        [[nodiscard]] static auto components(Tuple&& all)
+        {
+            using tuple_t = std::remove_cvref_t<Tuple>;
+            return[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+                return std::tuple<std::tuple_element_t<Is, tuple_t>...>(std::get<Is>(all)...);
+            }(std::make_index_sequence<std::tuple_size_v<tuple_t> - sizeof...(Fs)>{});
+        }
+    };
+
+    template <typename Repr, typename Filter, typename F>
+    void each(Repr& repr, Filter const& filter, F&& f)
+    {
+        if constexpr (!Filter::enabled) {
+            repr.each(FWD(f));
+        }
+        else {
+            repr.each([&filter, &f](entity_t const e, auto&... all) {
+                auto const yielded = std::forward_as_tuple(all...);
+                if (!filter.matches(yielded)) {
+                    return;
+                }
+
+                auto components = Filter::components(yielded);
+                if constexpr (is_const_applicable<F&, decltype(std::tuple_cat(std::make_tuple(e), components))>::value) {
+                    std::apply(f, std::tuple_cat(std::make_tuple(e), components));
+                }
+                else {
+                    std::apply(f, components);
+                }
+            });
+        }
+    }
+
+    // The packed entities of the query's storage are split into chunks of `batch_size`, which are iterated in place.
+    // Every entity belongs to exactly one chunk, so `f` may freely mutate the components it is handed.
+    // Anything else it can reach is shared between chunks, which is why `f` is only ever called through a const reference.
+    template <typename ReprT, typename Filter, typename F>
+    void par_each(typename ReprT::type const& repr, Filter const& filter, TaskPool const* const pool, std::size_t const batch_size, F const& f)
+    {
+        using components_t = decltype(Filter::components(std::declval<decltype(repr.get(std::declval<entity_t>()))>()));
+        // like `each`, `f` is handed the entity first if it takes one.
+        constexpr auto takes_entity = is_const_applicable<F, decltype(std::tuple_cat(std::make_tuple(entity_t{}), std::declval<components_t>()))>::value;
+        static_assert(takes_entity || is_const_applicable<F, components_t>::value,
+            "`par_each` shares `f` between threads, it must be callable through a const reference (e.g. not a `mutable` lambda)");
+        DEBUG_ASSERT(batch_size > 0, "`par_each` batch size must be greater than 0");
+
+        auto const packed = ReprT::packed(repr);
+        auto const run_chunk = [&repr, &filter, &f](std::span<entity_t const> const chunk) {
+            for (auto const e : chunk) {
+                if constexpr (!ReprT::packed_is_exact) {
+                    if (!repr.contains(e)) {
+                        continue;
+                    }
+                }
+
+                auto const yielded = repr.get(e);
+                if constexpr (Filter::enabled) {
+                    if (!filter.matches(yielded)) {
+                        continue;
+                    }
+                }
+                if constexpr (takes_entity) {
+                    std::apply(f, std::tuple_cat(std::make_tuple(e), Filter::components(yielded)));
+                }
+                else {
+                    std::apply(f, Filter::components(yielded));
+                }
+            }
+        };
+
+        if (pool == nullptr || pool->thread_count() == 0 || packed.size() <= batch_size) {
+            run_chunk(packed);
+            return;
+        }
+
+        pool->scope([&](TaskPool::Scope& scope) {
+            for (std::size_t i = 0; i < packed.size(); i += batch_size) {
+                auto const chunk = packed.subspan(i, std::min(batch_size, packed.size() - i));
+                scope.spawn([&run_chunk, chunk] { run_chunk(chunk); });
+            }
+        });
+    }
+
+} // namespace query_detail
+
+// `Added<T>` and `Changed<T>` filters inside `With<>` only yield the entities whose `T` was added/changed
+// since the system last ran. A filtered query can only be iterated with `each` and `par_each`.
+template <typename... Ws, typename... WOs, typename VG>
+class Query<With<Ws...>, Without<WOs...>, VG>
 {
-    using base_t = entt::group<entt::exclude_t<WOs...>, entt::get_t<>, Ws...>;
+    static_assert(std::is_same_v<VG, View> || std::is_same_v<VG, Group>, "Final Query<> param must be either a `View` or a `Group`");
+
+    using repr_t = query_detail::repr<query_detail::components_t<Ws...>, query_detail::filters_t<Ws...>, Without<WOs...>, VG>;
+    using filter_t = query_detail::ChangeFilter<query_detail::filters_t<Ws...>>;
+
+public:
+    using base_t = typename repr_t::type;
+
+private:
     base_t m_repr;
+    TaskPool const* m_pool = nullptr;
+    filter_t m_filter;
 
 public:
     template <typename T>
     requires (!std::is_same_v<std::remove_cvref_t<T>, Query>)
-        constexpr Query(T&& repr) noexcept : m_repr(FWD(repr)) {}
+        constexpr Query(T&& repr, TaskPool const* const pool = nullptr, tick_t const last_run = 0) noexcept 
+            : m_repr(FWD(repr))
+            , m_pool(pool)
+            , m_filter(last_run)
+        {}
+
+    [[nodiscard]] static auto create_repr(World& world) -> base_t
+    {
+        return repr_t::create(world);
+    }
 
-    auto begin() { return m_repr.begin(); }
-    auto end() { return m_repr.end(); }
+    auto begin() requires (!filter_t::enabled) { return m_repr.begin(); }
+    auto end() requires (!filter_t::enabled) { return m_repr.end(); }
+
+    template <typename F>
+    void each(F&& f) { query_detail::each(m_repr, m_filter, FWD(f)); }
 
+    // Like `each`, but splits the query's storage into chunks of `batch_size` entities which are run on the `TaskPool`.
+    // Runs on the calling thread if the query was created without a `TaskPool`.
     template <typename F>
-    void each(F&& f) { m_repr.each(FWD(f)); }
+    void par_each(std::size_t const batch_size, F const& f) const
+    {
+        query_detail::par_each<repr_t>(m_repr, m_filter, m_pool, batch_size, f);
+    }
 };
\ No newline at end of file
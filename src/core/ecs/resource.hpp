@@ -1,37 +1,95 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
 #include <tl/optional.hpp>
+#include <debug/debug.hpp>
 #include <util/common.hpp>
 #include <util/containers/hash.hpp>
 #include <util/containers/type_map.hpp>
 
+// Every live system gets its own dense `index`, even if another system has the same type (e.g. the same function
+// registered twice). The index of a released system is handed to the next system created, `generation` tells the
+// systems that held the same index apart. `id` only names the system's type.
 struct SystemId 
 { 
     type_id_t id;
-
-    constexpr SystemId(type_id_t const id) noexcept : id(id) {}
+    std::size_t index = 0;
+    std::uint32_t generation = 0;
+
+    constexpr SystemId(type_id_t const id, std::size_t const index, std::uint32_t const generation = 0) noexcept 
+        : id(id)
+        , index(index)
+        , generation(generation) 
+    {}
     constexpr SystemId(SystemId&&) noexcept = default;
     constexpr SystemId(SystemId const&) noexcept = default;
     constexpr SystemId& operator=(SystemId&&) noexcept = default;
     constexpr SystemId& operator=(SystemId const&) noexcept = default;
 
     template <typename T>
-    constexpr static auto create() noexcept -> SystemId
+    static auto create() -> SystemId
     {
-        return SystemId{ type_id<std::remove_cvref_t<T>>() };
+        auto const [index, generation] = indices().acquire();
+        return SystemId{ type_id<std::remove_cvref_t<T>>(), index, generation };
+    }
+
+    // hands `id`'s index to the next system created. Called once the system owning `id` is dropped.
+    static void release(SystemId const id)
+    {
+        indices().release(id.index);
     }
 
     constexpr auto operator==(SystemId const& rhs) const noexcept -> bool
     {
-        return id == rhs.id;
+        return index == rhs.index && generation == rhs.generation;
     }
     constexpr auto operator!=(SystemId const& rhs) const noexcept -> bool
     {
         return !(*this == rhs);
     }
+
+private:
+    class Indices
+    {
+        std::mutex m_mutex;
+        std::vector<std::uint32_t> m_generations; // indexed by `SystemId::index`
+        std::vector<std::size_t> m_free;
+
+    public:
+        auto acquire() -> std::pair<std::size_t, std::uint32_t>
+        {
+            auto const lock = std::scoped_lock(m_mutex);
+            if (m_free.empty()) {
+                m_generations.push_back(0);
+                return { m_generations.size() - 1, 0 };
+            }
+            auto const index = m_free.back();
+            m_free.pop_back();
+            return { index, m_generations[index] };
+        }
+
+        void release(std::size_t const index)
+        {
+            auto const lock = std::scoped_lock(m_mutex);
+            ++m_generations[index];
+            m_free.push_back(index);
+        }
+    };
+
+    static auto indices() -> Indices&
+    {
+        static auto indices = Indices{};
+        return indices;
+    }
 };
 
 template <>
@@ -39,7 +97,7 @@ struct std::hash<SystemId>
 {
     auto operator()(SystemId const& id) const noexcept -> std::size_t
     {
-        return static_cast<std::size_t>(id.id.hash());
+        return std::hash<std::size_t>{}(id.index);
     }
 };
 
@@ -87,9 +145,108 @@ public:
 namespace resource_detail {
     struct ResourceTag {};
     struct LocalTag {};
-}
 
-// TODO: Make Resources Thread Safe!
+    // `0` when the resource is not borrowed, `n > 0` for `n` shared borrows and `-1` for an exclusive borrow.
+    // Borrows are only tracked in debug builds, in release builds borrowing a resource does nothing.
+    class BorrowState
+    {
+#ifdef IS_DEBUG
+        std::atomic<int> m_state{ 0 };
+#endif
+
+    public:
+        BorrowState() noexcept = default;
+        BorrowState(BorrowState const&) = delete;
+        BorrowState& operator=(BorrowState const&) = delete;
+
+        void borrow_shared([[maybe_unused]] std::string_view const name) noexcept
+        {
+#ifdef IS_DEBUG
+            auto state = m_state.load(std::memory_order_relaxed);
+            do {
+                DEBUG_ASSERT(state >= 0, "Cannot borrow '{}', it is already borrowed mutably.", name);
+            } while (!m_state.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed));
+#endif
+        }
+
+        void release_shared() noexcept
+        {
+#ifdef IS_DEBUG
+            m_state.fetch_sub(1, std::memory_order_release);
+#endif
+        }
+
+        void borrow_exclusive([[maybe_unused]] std::string_view const name) noexcept
+        {
+#ifdef IS_DEBUG
+            auto state = 0;
+            if (!m_state.compare_exchange_strong(state, -1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                PANIC("Cannot borrow '{}' mutably, it is already borrowed {}.", name, state < 0 ? "mutably" : "immutably");
+            }
+#endif
+        }
+
+        void release_exclusive() noexcept
+        {
+#ifdef IS_DEBUG
+            m_state.store(0, std::memory_order_release);
+#endif
+        }
+
+        [[nodiscard]] auto is_borrowed() const noexcept -> bool
+        {
+#ifdef IS_DEBUG
+            return m_state.load(std::memory_order_relaxed) != 0;
+#else
+            return false;
+#endif
+        }
+    };
+
+    // `T const` is borrowed shared, anything else exclusively.
+    template <typename T>
+    void borrow(BorrowState& state) noexcept
+    {
+        if constexpr (std::is_const_v<T>) {
+            state.borrow_shared(type_name<std::remove_const_t<T>>());
+        }
+        else {
+            state.borrow_exclusive(type_name<T>());
+        }
+    }
+
+    template <typename T>
+    void release(BorrowState& state) noexcept
+    {
+        if constexpr (std::is_const_v<T>) {
+            state.release_shared();
+        }
+        else {
+            state.release_exclusive();
+        }
+    }
+
+    // What `Resources` stores for every resource. The value has its own allocation, so that it can be handed out by `remove_resource()`.
+    // Entries are shared with the borrows of the resource, so replacing a resource never frees an entry that is still borrowed.
+    template <typename T>
+    struct ResourceEntry
+    {
+        std::unique_ptr<T> value;
+        BorrowState mutable borrow;
+
+        template <typename... Args>
+        explicit ResourceEntry(in_place_t, Args&&... args)
+            : value(std::make_unique<T>(FWD(args)...))
+        {}
+    };
+
+} // namespace resource_detail
+
+// Specialize for resources that may only be touched from the main thread (e.g. SDL renderer state).
+// Any system that takes such a resource is never dispatched to a worker thread.
+template <typename T>
+struct is_main_thread_resource : std::false_type {};
+
 template <typename T>
 using Resource = ResourceBase<T, resource_detail::ResourceTag>;
 
@@ -120,40 +277,127 @@ constexpr auto make_const_local_resource(T const& value) -> Local<T const>
     return make_const_resource<T, resource_detail::LocalTag>(value);
 }
 
+// Borrows a resource for as long as the guard is alive, see `Resources::read_resource()` and `Resources::write_resource()`.
+// Unlike `Resource<T>`, the borrow is checked against every other borrow of the resource in debug builds.
+template <typename T>
+class ResourceGuard
+{
+    T* m_ptr;
+    std::shared_ptr<resource_detail::BorrowState> m_borrow; // keeps the resource's entry alive
+
+public:
+    ResourceGuard(T& value, std::shared_ptr<resource_detail::BorrowState> borrow) noexcept
+        : m_ptr(std::addressof(value))
+        , m_borrow(MOV(borrow))
+    {
+        resource_detail::borrow<T>(*m_borrow);
+    }
+
+    ResourceGuard(ResourceGuard&& other) noexcept
+        : m_ptr(other.m_ptr)
+        , m_borrow(MOV(other.m_borrow))
+    {}
+
+    ResourceGuard& operator=(ResourceGuard&& other) noexcept
+    {
+        if (this != std::addressof(other)) {
+            release();
+            m_ptr = other.m_ptr;
+            m_borrow = MOV(other.m_borrow);
+        }
+        return *this;
+    }
+
+    ResourceGuard(ResourceGuard const&) = delete;
+    ResourceGuard& operator=(ResourceGuard const&) = delete;
+
+    ~ResourceGuard() noexcept { release(); }
+
+    void release() noexcept
+    {
+        if (m_borrow) {
+            resource_detail::release<T>(*m_borrow);
+            m_borrow.reset();
+        }
+    }
+
+    [[nodiscard]] auto operator*() const noexcept -> T& { return *m_ptr; }
+    [[nodiscard]] auto operator->() const noexcept -> T* { return m_ptr; }
+};
+
+template <typename T>
+using ResourceReadGuard = ResourceGuard<T const>;
+
+template <typename T>
+using ResourceWriteGuard = ResourceGuard<T>;
+
+// Locals are stored in a flat array of slots indexed by `SystemId::index`, so it only grows with the number of live
+// systems. A slot still holding the locals of a released system is cleared once the system reusing its index stores one.
 class LocalResources
 {
-    HashMap<SystemId, TypeMap> m_local_resources;
+    struct Slot
+    {
+        std::uint32_t generation = 0; // `SystemId::generation` of the system the locals belong to
+        TypeMap locals;
+    };
+
+    std::vector<Slot> m_slots;
+    std::size_t m_generation = 0;
+
+    auto slot(SystemId const id) -> TypeMap&
+    {
+        if (id.index >= m_slots.size()) {
+            m_slots.resize(id.index + 1);
+        }
+        auto& slot = m_slots[id.index];
+        if (slot.generation != id.generation) {
+            slot.locals.clear();
+            slot.generation = id.generation;
+        }
+        return slot.locals;
+    }
+
+    [[nodiscard]] auto find_slot(SystemId const id) const noexcept -> TypeMap const*
+    {
+        if (id.index < m_slots.size() && m_slots[id.index].generation == id.generation) {
+            return std::addressof(m_slots[id.index].locals);
+        }
+        return nullptr;
+    }
+
+    [[nodiscard]] auto find_slot(SystemId const id) noexcept -> TypeMap*
+    {
+        return const_cast<TypeMap*>(std::as_const(*this).find_slot(id));
+    }
 
 public:
     template <typename T, typename... Args>
     auto try_add_local_resource(SystemId const id, Args&&... args) -> Local<T>
     {
-        auto [iter, ok] = m_local_resources.try_emplace(id);
-        UNUSED(ok);
+        auto& locals = slot(id);
 
-        T& local = iter->second.try_add<std::remove_cvref_t<T>>(FWD(args)...);
+        auto const size = locals.size();
+        T& local = locals.try_add<std::remove_cvref_t<T>>(FWD(args)...);
+        if (size != locals.size()) {
+            ++m_generation;
+        }
         return Local(local);
     }
 
     template <typename T, typename... Args>
     auto set_local_resource(SystemId const id, Args&&... args) -> Local<T>
     {
-        auto [iter, ok] = m_local_resources.try_emplace(id);
-        UNUSED(ok);
-
-        T& local = iter->second.set<std::remove_cvref_t<T>>(FWD(args)...);
+        T& local = slot(id).set<std::remove_cvref_t<T>>(FWD(args)...);
+        ++m_generation;
         return Local(local);
     }
 
     template <typename T>
     auto remove_local_resource(SystemId const id) -> std::unique_ptr<T>
     {
-        if (auto const iter = m_local_resources.find(id); iter != m_local_resources.end()) {
-            auto ptr = iter->second.remove<std::remove_cvref_t<T>>();
-            if (iter->second.empty()) { // remove the local resources if 
-                m_local_resources.erase(iter);
-            }
-            return ptr;
+        if (auto const locals = find_slot(id); locals != nullptr) {
+            ++m_generation;
+            return locals->remove<std::remove_cvref_t<T>>();
         }
         return nullptr;
     }
@@ -161,8 +405,8 @@ public:
     template <typename T>
     [[nodiscard]] auto contains_local_resource(SystemId const id) const -> bool
     {
-        if (auto const iter = m_local_resources.find(id); iter != m_local_resources.end()) {
-            return iter->second.contains<std::remove_cvref_t<T>>();
+        if (auto const locals = find_slot(id); locals != nullptr) {
+            return locals->contains<std::remove_cvref_t<T>>();
         }
         return false;
     }
@@ -170,8 +414,8 @@ public:
     template <typename T>
     [[nodiscard]] auto get_local_resource(SystemId const id) -> tl::optional<Local<T>>
     {
-        if (auto const iter = m_local_resources.find(id); iter != m_local_resources.end()) {
-            return iter->second.get<std::remove_cvref_t<T>>().map([](T& value) { return make_local_resource(value); });
+        if (auto const locals = find_slot(id); locals != nullptr) {
+            return locals->get<std::remove_cvref_t<T>>().map([](T& value) { return make_local_resource(value); });
         }
         return {};
     }
@@ -179,8 +423,8 @@ public:
     template <typename T>
     [[nodiscard]] auto get_local_resource(SystemId const id) const -> tl::optional<Local<T const>>
     {
-        if (auto const iter = m_local_resources.find(id); iter != m_local_resources.end()) {
-            return iter->second.get<std::remove_cvref_t<T>>().map([](T const& value) { return make_const_local_resource(value); });
+        if (auto const locals = find_slot(id); locals != nullptr) {
+            return locals->get<std::remove_cvref_t<T>>().map([](T const& value) { return make_const_local_resource(value); });
         }
         return {};
     }
@@ -188,72 +432,176 @@ public:
     template <typename T>
     [[nodiscard]] auto cget_local_resource(SystemId const id) const -> tl::optional<Local<T const>>
     {
-        return get_local_resource<std::remove_cvref_t<T>>();
+        return get_local_resource<std::remove_cvref_t<T>>(id);
     }
 
     void clear_local_resources(SystemId const id)
     {
-        m_local_resources.erase(id);
+        if (auto const locals = find_slot(id); locals != nullptr) {
+            locals->clear();
+        }
+        ++m_generation;
     }
 
     void clear_all_local_resources() noexcept
     {
-        m_local_resources.clear();
+        m_slots.clear();
+        ++m_generation;
+    }
+
+    // changes every time a local resource is added, replaced or removed.
+    [[nodiscard]] auto generation() const noexcept -> std::size_t
+    {
+        return m_generation;
     }
 
     [[nodiscard]] auto local_resource_count(SystemId const id) const noexcept -> tl::optional<std::size_t>
     {
-        if (auto const iter = m_local_resources.find(id); iter != m_local_resources.end()) {
-            return iter->second.size();
+        if (auto const locals = find_slot(id); locals != nullptr && !locals->empty()) {
+            return locals->size();
         }
         return {};
     }
 };
 
+// Resources are heap allocated, so pointers to them stay valid until the resource is replaced or removed.
+// `generation()` changes whenever that might have happened, which lets systems cache their resource pointers.
+//
+// Looking up, adding and removing resources is safe from any thread. Access to the resources themselves goes through
+// borrows: systems borrow their `Resource<>` arguments for as long as they run, and any other code (e.g. asset loading
+// tasks) should use `read_resource()` / `write_resource()`. Conflicting borrows, including replacing or removing a borrowed
+// resource, panic in debug builds. A borrow keeps its entry alive, so a resource replaced in the meantime is freed once
+// the last borrow of it is released. `Resource<T>` handles returned by `get_resource()` are not tracked.
+// Local resources are owned by a single system and are only touched from the main thread.
 class Resources
 {
+    template <typename T>
+    using entry_t = resource_detail::ResourceEntry<std::remove_cvref_t<T>>;
+
+    template <typename T>
+    using entry_ptr_t = std::shared_ptr<entry_t<T>>;
+
     TypeMap m_resources;
+    std::shared_mutex mutable m_mutex;
     LocalResources m_local_resources;
+    std::atomic<std::size_t> m_generation{ 0 };
+    std::uint64_t m_instance_id = next_instance_id();
+
+    [[nodiscard]] static auto next_instance_id() noexcept -> std::uint64_t
+    {
+        static std::atomic<std::uint64_t> next_id{ 1 };
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // must be called with `m_mutex` held.
+    template <typename T>
+    [[nodiscard]] auto find_entry() const -> entry_t<T>*
+    {
+        return m_resources.get<entry_ptr_t<T>>().map([](auto const& entry) { return entry.get(); }).value_or(nullptr);
+    }
+
+    // borrows `T` while the entry can not be replaced, the guard keeps the entry alive afterwards.
+    template <typename T>
+    [[nodiscard]] auto borrow_entry() const -> tl::optional<ResourceGuard<T>>
+    {
+        auto const lock = std::shared_lock(m_mutex);
+        if (auto const entry = m_resources.get<entry_ptr_t<T>>(); entry) {
+            auto& value = *(*entry)->value;
+            return ResourceGuard<T>(value, std::shared_ptr<resource_detail::BorrowState>(*entry, std::addressof((*entry)->borrow)));
+        }
+        return {};
+    }
 
 public:
+    Resources() = default;
+
+    Resources(Resources&& other) noexcept
+    {
+        auto const lock = std::scoped_lock(other.m_mutex);
+        m_resources = MOV(other.m_resources);
+        m_local_resources = MOV(other.m_local_resources);
+        m_generation.store(other.m_generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.m_instance_id = next_instance_id();
+    }
+
+    Resources& operator=(Resources&& other) noexcept
+    {
+        if (this != std::addressof(other)) {
+            auto const lock = std::scoped_lock(m_mutex, other.m_mutex);
+            m_resources = MOV(other.m_resources);
+            m_local_resources = MOV(other.m_local_resources);
+            m_generation.fetch_add(other.m_generation.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            m_instance_id = next_instance_id();
+            other.m_instance_id = next_instance_id();
+        }
+        return *this;
+    }
+
+    Resources(Resources const&) = delete;
+    Resources& operator=(Resources const&) = delete;
 
     // Resources
     template <typename T, typename... Args>
     auto try_add_resource(Args&&... args) -> Resource<T>
     {
-        T& resource = m_resources.try_add<std::remove_cvref_t<T>>(FWD(args)...);
+        auto const lock = std::scoped_lock(m_mutex);
+        if (auto const entry = find_entry<T>(); entry) {
+            return Resource<T>(*entry->value);
+        }
+        T& resource = *m_resources.set<entry_ptr_t<T>>(std::make_shared<entry_t<T>>(in_place, FWD(args)...))->value;
+        m_generation.fetch_add(1, std::memory_order_relaxed);
         return Resource(resource);
     }
 
     template <typename T, typename... Args>
     auto set_resource(Args&&... args) -> Resource<T>
     {
-        T& resource = m_resources.set<std::remove_cvref_t<T>>(FWD(args)...);
+        auto const lock = std::scoped_lock(m_mutex);
+        if (auto const old = find_entry<T>(); old) {
+            DEBUG_ASSERT(!old->borrow.is_borrowed(), "Cannot replace '{}' while it is borrowed.", type_name<std::remove_cvref_t<T>>());
+        }
+        T& resource = *m_resources.set<entry_ptr_t<T>>(std::make_shared<entry_t<T>>(in_place, FWD(args)...))->value;
+        m_generation.fetch_add(1, std::memory_order_relaxed);
         return Resource(resource);
     }
 
     template <typename T>
     auto remove_resource() -> std::unique_ptr<T>
     {
-        return m_resources.remove<std::remove_cvref_t<T>>();
+        auto const lock = std::scoped_lock(m_mutex);
+        m_generation.fetch_add(1, std::memory_order_relaxed);
+        if (auto const entry = m_resources.remove<entry_ptr_t<T>>(); entry) {
+            DEBUG_ASSERT(!(*entry)->borrow.is_borrowed(), "Cannot remove '{}' while it is borrowed.", type_name<std::remove_cvref_t<T>>());
+            return MOV((*entry)->value);
+        }
+        return nullptr;
     }
 
     template <typename T>
-    [[nodiscard]] auto contains_resource() -> bool
+    [[nodiscard]] auto contains_resource() const -> bool
     {
-        return m_resources.contains<std::remove_cvref_t<T>>();
+        auto const lock = std::shared_lock(m_mutex);
+        return m_resources.contains<entry_ptr_t<T>>();
     }
 
     template <typename T>
     [[nodiscard]] auto get_resource() -> tl::optional<Resource<T>>
     {
-        return m_resources.get<std::remove_cvref_t<T>>().map([](T& value) { return make_resource(value); });
+        auto const lock = std::shared_lock(m_mutex);
+        if (auto const entry = find_entry<T>(); entry) {
+            return make_resource<T>(*entry->value);
+        }
+        return {};
     }
 
     template <typename T>
     [[nodiscard]] auto get_resource() const -> tl::optional<Resource<T const>>
     {
-        return m_resources.get<std::remove_cvref_t<T>>().map([](T const& value) { return make_const_resource(value); });
+        auto const lock = std::shared_lock(m_mutex);
+        if (auto const entry = find_entry<T>(); entry) {
+            return make_const_resource<std::remove_cvref_t<T>>(*entry->value);
+        }
+        return {};
     }
 
     template <typename T>
@@ -262,13 +610,55 @@ public:
         return get_resource<std::remove_cvref_t<T>>();
     }
 
+    // shared borrow of `T`, for as long as the guard is alive.
+    template <typename T>
+    [[nodiscard]] auto read_resource() const -> tl::optional<ResourceReadGuard<std::remove_cvref_t<T>>>
+    {
+        return borrow_entry<std::remove_cvref_t<T> const>();
+    }
+
+    // exclusive borrow of `T`, for as long as the guard is alive.
+    template <typename T>
+    [[nodiscard]] auto write_resource() -> tl::optional<ResourceWriteGuard<std::remove_cvref_t<T>>>
+    {
+        return borrow_entry<std::remove_cvref_t<T>>();
+    }
+
+    // the borrow state of `T`, used by systems to borrow their arguments while they run.
+    // it keeps the entry alive, so a system that has not noticed a replaced resource yet never borrows freed memory.
+    template <typename T>
+    [[nodiscard]] auto borrow_state() const -> std::shared_ptr<resource_detail::BorrowState>
+    {
+        auto const lock = std::shared_lock(m_mutex);
+        if (auto const entry = m_resources.get<entry_ptr_t<T>>(); entry) {
+            return std::shared_ptr<resource_detail::BorrowState>(*entry, std::addressof((*entry)->borrow));
+        }
+        return nullptr;
+    }
+
     auto clear_resources()
     {
+        auto const lock = std::scoped_lock(m_mutex);
         m_resources.clear();
+        m_generation.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // unique for every `Resources` ever created, and changed when its contents are moved in or out.
+    // unlike the address, it can not be shared with a `Resources` that used to live in the same place.
+    [[nodiscard]] auto instance_id() const noexcept -> std::uint64_t
+    {
+        return m_instance_id;
+    }
+
+    // changes every time a resource or local resource is added, replaced or removed.
+    [[nodiscard]] auto generation() const noexcept -> std::size_t
+    {
+        return m_generation.load(std::memory_order_relaxed) + m_local_resources.generation();
     }
 
     [[nodiscard]] auto resource_count() const noexcept -> std::size_t
     {
+        auto const lock = std::shared_lock(m_mutex);
         return m_resources.size();
     }
 
@@ -281,4 +671,4 @@ public:
     {
         return m_local_resources;
     }
-};
\ No newline at end of file
+};
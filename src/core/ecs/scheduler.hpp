@@ -4,11 +4,16 @@
 #include "system.hpp"
 #include "world.hpp"
 
+#include <core/diagnostics/diagnostics.hpp>
+#include <core/diagnostics/trace.hpp>
+#include <core/task/task_pool.hpp>
 #include <debug/debug.hpp>
 #include <util/common.hpp>
 #include <util/rng.hpp>
 
 #include <algorithm>
+#include <functional>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -43,10 +48,157 @@ class Stage
 {
 protected:
     std::vector<System> m_systems;
+    // indices into `m_systems`, grouped into batches of systems that do not conflict with each other.
+    std::vector<std::vector<std::size_t>> m_batches;
+    // indices into `m_systems` in the order they run when the stage runs sequentially.
+    std::vector<std::size_t> m_order;
+    std::size_t m_built_systems = 0;
     StageId m_id;
 
+#ifdef ENABLE_DIAGNOSTICS
+    // one entry per system in `m_systems`, all null if there is no `Diagnostics` resource.
+    std::vector<Diagnostic*> m_system_diagnostics;
+    Diagnostic* m_stage_diagnostic = nullptr;
+    std::uint64_t m_diagnostics_resources = 0; // `Resources::instance_id()`
+    std::size_t m_diagnostics_generation = 0;
+
+    void prepare_diagnostics(Resources& resources)
+    {
+        bool const up_to_date = m_diagnostics_resources == resources.instance_id()
+            && m_diagnostics_generation == resources.generation()
+            && m_system_diagnostics.size() == m_systems.size();
+        if (up_to_date) {
+            return;
+        }
+
+        m_diagnostics_resources = resources.instance_id();
+        m_diagnostics_generation = resources.generation();
+
+        auto const diagnostics = resources.get_resource<Diagnostics>().map([](auto d) { return std::addressof(*d); }).value_or(nullptr);
+        m_stage_diagnostic = diagnostics ? std::addressof(diagnostics->register_stage(m_id.id)) : nullptr;
+        m_system_diagnostics.clear();
+        for (auto const& system : m_systems) {
+            m_system_diagnostics.push_back(diagnostics ? std::addressof(diagnostics->register_system(system.id())) : nullptr);
+        }
+    }
+#endif
+
+    void run_system(std::size_t const index, Resources& resources, World& world)
+    {
+#ifdef ENABLE_DIAGNOSTICS
+        auto const timer = DiagnosticTimer(m_system_diagnostics[index]);
+#endif
+        TRACE_SCOPE(m_systems[index].id().id.name(), "system");
+        m_systems[index].run_prepared(resources, world);
+    }
+
     Stage(StageId const id) noexcept : m_id(id) {}
 
+    // edges[i] holds every system that has to run after system `i` because of its `before`/`after` labels.
+    auto ordering_edges() const -> std::vector<std::vector<std::size_t>>
+    {
+        auto edges = std::vector<std::vector<std::size_t>>(m_systems.size());
+
+        auto const for_each_labeled = [this](SystemLabel const label, std::size_t const self, auto&& f) {
+            bool found = false;
+            for (std::size_t j = 0; j < m_systems.size(); ++j) {
+                if (j != self && std::ranges::find(m_systems[j].labels(), label) != m_systems[j].labels().end()) {
+                    found = true;
+                    f(j);
+                }
+            }
+            if (!found) {
+                LOG_WARN("System '{}' is ordered relative to label '{}', which no other system in stage '{}' has.",
+                    m_systems[self].id().id.name(), label.id.name(), m_id.id.name());
+            }
+        };
+
+        for (std::size_t i = 0; i < m_systems.size(); ++i) {
+            for (auto const label : m_systems[i].before_labels()) {
+                for_each_labeled(label, i, [&](std::size_t const j) { edges[i].push_back(j); });
+            }
+            for (auto const label : m_systems[i].after_labels()) {
+                for_each_labeled(label, i, [&](std::size_t const j) { edges[j].push_back(i); });
+            }
+        }
+
+        return edges;
+    }
+
+    // Resolving a system's arguments can mutate the `Resources` and `World`, so it is done up front on the calling thread.
+    // Resolving one system can add resources or locals that make the systems resolved before it stale again,
+    // so this repeats until a pass resolves nothing.
+    void prepare_systems(Resources& resources, World& world)
+    {
+        for (bool resolved = true; resolved;) {
+            resolved = false;
+            for (auto& system : m_systems) {
+                resolved |= system.prepare(resources, world);
+            }
+        }
+
+        if (m_built_systems != m_systems.size()) {
+            build();
+        }
+
+#ifdef ENABLE_DIAGNOSTICS
+        prepare_diagnostics(resources);
+#endif
+    }
+
+    void run_batch(std::vector<std::size_t> const& batch, TaskPool const& pool, Resources& resources, World& world)
+    {
+        pool.scope([&](TaskPool::Scope& scope) {
+            for (auto const index : batch) {
+                auto& system = m_systems[index];
+                if (!system.should_run() || system.access().is_main_thread()) {
+                    continue;
+                }
+                scope.spawn([this, index, &resources, &world] { run_system(index, resources, world); });
+            }
+
+            // main thread systems run on the calling thread while the workers are busy.
+            for (auto const index : batch) {
+                auto& system = m_systems[index];
+                if (system.should_run() && system.access().is_main_thread()) {
+                    run_system(index, resources, world);
+                }
+            }
+        });
+    }
+
+    void run_systems(Resources& resources, World& world)
+    {
+        auto pool = resources.get_resource<TaskPool const>();
+        if (!pool || (*pool)->thread_count() == 0) {
+            for (auto const i : m_order) {
+                if (m_systems[i].should_run()) {
+                    run_system(i, resources, world);
+                }
+            }
+            return;
+        }
+
+        for (auto const& batch : m_batches) {
+            if (batch.size() == 1) {
+                if (m_systems[batch.front()].should_run()) {
+                    run_system(batch.front(), resources, world);
+                }
+            }
+            else {
+                run_batch(batch, **pool, resources, world);
+            }
+        }
+    }
+
+    // deferred commands are applied in system order, so the result does not depend on how the systems were scheduled.
+    void apply_systems(Resources& resources, World& world)
+    {
+        for (auto const i : m_order) {
+            m_systems[i].apply(resources, world);
+        }
+    }
+
 public:
     template <typename StageTag>
     static auto create() -> Stage
@@ -56,22 +208,102 @@ public:
 
     Stage(Stage&&) noexcept = default;
     Stage& operator=(Stage&&) noexcept = default;
+    virtual ~Stage() = default;
 
     constexpr auto id() const noexcept { return m_id; }
 
     template <typename S>
-    void add_system(S&& s)
+    auto add_system(S&& s) -> System&
     {
-        m_systems.emplace_back(FWD(s));
+        return m_systems.emplace_back(FWD(s));
     }
 
-    void run(Resources& resources, World& world)
+    [[nodiscard]] auto batches() const noexcept -> std::vector<std::vector<std::size_t>> const&
     {
-        for (auto& system : m_systems) {
-            if (system.should_run()) {
-                system.run(resources, world);
+        return m_batches;
+    }
+
+    // Sorts the systems topologically (ties are broken by insertion order), and then places every system
+    // in the batch directly after the last batch containing a system it conflicts with or has to run after.
+    // This keeps the order between dependent systems while letting independent systems run together.
+    // Panics if the labels form a cycle. Runs before the stage first runs, and again whenever systems were added.
+    void build()
+    {
+        auto const edges = ordering_edges();
+
+        auto in_degree = std::vector<std::size_t>(m_systems.size(), 0);
+        for (auto const& to : edges) {
+            for (auto const j : to) {
+                ++in_degree[j];
+            }
+        }
+
+        m_order.clear();
+        auto ready = std::vector<std::size_t>{};
+        for (std::size_t i = m_systems.size(); i-- > 0;) {
+            if (in_degree[i] == 0) {
+                ready.push_back(i);
+            }
+        }
+
+        while (!ready.empty()) {
+            // `ready` is kept sorted in descending order, so the earliest added system is at the back.
+            auto const i = ready.back();
+            ready.pop_back();
+            m_order.push_back(i);
+
+            for (auto const j : edges[i]) {
+                if (--in_degree[j] == 0) {
+                    ready.insert(std::ranges::upper_bound(ready, j, std::greater<>{}), j);
+                }
             }
         }
+
+        if (m_order.size() != m_systems.size()) {
+            auto cycle = std::string{};
+            for (std::size_t i = 0; i < m_systems.size(); ++i) {
+                if (in_degree[i] != 0) {
+                    cycle += fmt::format("\n    '{}'", m_systems[i].id().id.name());
+                }
+            }
+            PANIC("Stage '{}' contains a cycle between the systems:{}", m_id.id.name(), cycle);
+        }
+
+        m_batches.clear();
+        auto system_batch = std::vector<std::size_t>(m_systems.size(), 0);
+        for (std::size_t p = 0; p < m_order.size(); ++p) {
+            auto const i = m_order[p];
+
+            std::size_t batch = 0;
+            for (std::size_t q = 0; q < p; ++q) {
+                auto const j = m_order[q];
+                bool const ordered = std::ranges::find(edges[j], i) != edges[j].end();
+                if (ordered || m_systems[i].access().conflicts_with(m_systems[j].access())) {
+                    batch = std::max(batch, system_batch[j] + 1);
+                }
+            }
+
+            system_batch[i] = batch;
+            if (batch == m_batches.size()) {
+                m_batches.emplace_back();
+            }
+            m_batches[batch].push_back(i);
+        }
+
+        m_built_systems = m_systems.size();
+    }
+
+    // Runs non-conflicting systems in parallel if a `TaskPool` resource exists, otherwise runs every system in order.
+    // Once every system has run, their deferred commands are applied.
+    virtual void run(Resources& resources, World& world)
+    {
+        prepare_systems(resources, world);
+#ifdef ENABLE_DIAGNOSTICS
+        auto const timer = DiagnosticTimer(m_stage_diagnostic);
+#endif
+        TRACE_SCOPE(m_id.id.name(), "stage");
+        run_systems(resources, world);
+        apply_systems(resources, world);
     }
 };
 
@@ -79,6 +311,7 @@ class Scheduler
 {
     std::vector<std::unique_ptr<Stage>> m_startup_stages;
     std::vector<std::unique_ptr<Stage>> m_stages;
+    System* m_last_added_system = nullptr;
 
     static auto extract_stage_id(std::unique_ptr<Stage> const& stage) noexcept -> StageId
     {
@@ -86,29 +319,35 @@ class Scheduler
     }
 
     template <typename StageTag, typename F>
-    static auto add_system_to_stage_impl(std::vector<std::unique_ptr<Stage>>& stages, F&& f) -> SystemId
+    auto add_system_to_stage_impl(std::vector<std::unique_ptr<Stage>>& stages, F&& f) -> SystemId
     {
         auto const iter = std::ranges::find(std::as_const(stages), StageId::create<StageTag>(), extract_stage_id);
         DEBUG_ASSERT(iter != stages.end(), "Cannot add system to stage '{}' as the stage does not exist.", type_name<StageTag>());
 
-        auto system = System::create(FWD(f));
-        auto const id = system.id();
-        (*iter)->add_system(MOV(system));
+        auto& system = (*iter)->add_system(System::create(FWD(f)));
+        m_last_added_system = std::addressof(system);
+        return system.id();
+    }
 
-        return id;
+    // `StageT` is the type of stage to create, `Stage` or a type derived from it (e.g. one that runs its systems more than once).
+    template <typename NewStage, typename StageT>
+    static auto make_stage() -> std::unique_ptr<Stage>
+    {
+        static_assert(std::is_base_of_v<Stage, StageT>, "Stages have to derive from `Stage`");
+        return std::make_unique<StageT>(StageT::template create<NewStage>());
     }
 
-    template <typename NewStage>
+    template <typename NewStage, typename StageT>
     static auto add_stage_impl(std::vector<std::unique_ptr<Stage>>& stages) -> StageId
     {
         DEBUG_ASSERT(
             std::ranges::find(std::as_const(stages), StageId::create<NewStage>(), extract_stage_id) == stages.end(), 
             "Stage '{}' already exists.", 
             type_name<NewStage>());
-        return stages.emplace_back(std::make_unique<Stage>(Stage::create<NewStage>()))->id();
+        return stages.emplace_back(make_stage<NewStage, StageT>())->id();
     }
 
-    template <typename NewStage, typename StageBefore>
+    template <typename NewStage, typename StageBefore, typename StageT>
     static auto add_stage_before_impl(std::vector<std::unique_ptr<Stage>>& stages) -> StageId
     {
         auto const iter = std::ranges::find(std::as_const(stages), StageId::create<StageBefore>(), extract_stage_id);
@@ -118,10 +357,10 @@ class Scheduler
             type_name<NewStage>(), 
             type_name<StageBefore>(), 
             type_name<StageBefore>());
-        return (*stages.insert(iter, std::make_unique<Stage>(Stage::create<NewStage>())))->id();
+        return (*stages.insert(iter, make_stage<NewStage, StageT>()))->id();
     }
 
-    template <typename NewStage, typename StageAfter>
+    template <typename NewStage, typename StageAfter, typename StageT>
     static auto add_stage_after_impl(std::vector<std::unique_ptr<Stage>>& stages) -> StageId
     {
         auto const iter = std::ranges::find(std::as_const(stages), StageId::create<StageAfter>(), extract_stage_id);
@@ -131,7 +370,7 @@ class Scheduler
             type_name<NewStage>(),
             type_name<StageAfter>(),
             type_name<StageAfter>());
-        return (*stages.insert(std::next(iter), std::make_unique<Stage>(Stage::create<NewStage>())))->id();
+        return (*stages.insert(std::next(iter), make_stage<NewStage, StageT>()))->id();
     }
 
 public:
@@ -142,22 +381,22 @@ public:
         return add_system_to_stage_impl<StageTag>(m_stages, FWD(f));
     }
 
-    template <typename StageTag>
+    template <typename StageTag, typename StageT = Stage>
     auto add_stage()
     {
-        return add_stage_impl<StageTag>(m_stages);
+        return add_stage_impl<StageTag, StageT>(m_stages);
     }
 
-    template <typename StageTag, typename StageBefore>
+    template <typename StageTag, typename StageBefore, typename StageT = Stage>
     auto add_stage_before()
     {
-        return add_stage_before_impl<StageTag, StageBefore>(m_stages);
+        return add_stage_before_impl<StageTag, StageBefore, StageT>(m_stages);
     }
 
-    template <typename StageTag, typename StageAfter>
+    template <typename StageTag, typename StageAfter, typename StageT = Stage>
     auto add_stage_after()
     {
-        return add_stage_after_impl<StageTag, StageAfter>(m_stages);
+        return add_stage_after_impl<StageTag, StageAfter, StageT>(m_stages);
     }
 
     // startup_stage
@@ -170,19 +409,38 @@ public:
     template <typename StageTag>
     auto add_startup_stage()
     {
-        return add_stage_impl<StageTag>(m_startup_stages);
+        return add_stage_impl<StageTag, Stage>(m_startup_stages);
     }
 
     template <typename StageTag, typename StageBefore>
     auto add_startup_stage_before()
     {
-        return add_stage_before_impl<StageTag, StageBefore>(m_startup_stages);
+        return add_stage_before_impl<StageTag, StageBefore, Stage>(m_startup_stages);
     }
 
     template <typename StageTag, typename StageAfter>
     auto add_startup_stage_after()
     {
-        return add_stage_after_impl<StageTag, StageAfter>(m_startup_stages);
+        return add_stage_after_impl<StageTag, StageAfter, Stage>(m_startup_stages);
+    }
+
+    // The system that was added last, used to configure its labels and ordering.
+    // Only valid until the next system is added to the same stage.
+    [[nodiscard]] auto last_added_system() noexcept -> System&
+    {
+        DEBUG_ASSERT(m_last_added_system != nullptr, "No system has been added yet.");
+        return *m_last_added_system;
+    }
+
+    // Builds the execution order of every stage up front, so ordering cycles are reported before the game runs.
+    void build()
+    {
+        for (auto& stage : m_startup_stages) {
+            stage->build();
+        }
+        for (auto& stage : m_stages) {
+            stage->build();
+        }
     }
 
     // running stages
@@ -195,6 +453,10 @@ public:
 
     void run_stages(Resources& resources, World& world)
     {
+#ifdef ENABLE_DIAGNOSTICS
+        auto const frame_diagnostic = resources.get_resource<Diagnostics>().map([](auto d) { return std::addressof(d->frame()); });
+        auto const timer = DiagnosticTimer(frame_diagnostic.value_or(nullptr));
+#endif
         for (auto& stage : m_stages) {
             stage->run(resources, world);
         }
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <entt/entt.hpp>
+#include <vector>
 #include <core/game/events.hpp>
+#include <core/game/parallel_events.hpp>
+#include "access.hpp"
+#include "change_detection.hpp"
 #include "commands.hpp"
 #include "util/meta.hpp"
 #include "util/common.hpp"
+#include "util/void_ptr.hpp"
 #include "query.hpp"
 #include "resource.hpp"
 #include "world.hpp"
@@ -13,6 +18,7 @@ class SystemSettings
 {
     SystemId m_id;
     bool m_should_run = true;
+    tick_t m_last_run_tick = 0;
 
 public:
     constexpr SystemSettings(SystemId const id, bool const should_run) noexcept
@@ -26,49 +32,14 @@ public:
     constexpr auto id() const noexcept -> SystemId { return m_id; }
     constexpr auto should_run() const noexcept -> bool { return m_should_run; }
     constexpr void set_should_run(bool const b) noexcept { m_should_run = b; }
+
+    // the `ChangeTick` of the system's previous run, `Added<>`/`Changed<>` filters match anything newer.
+    constexpr auto last_run_tick() const noexcept -> tick_t { return m_last_run_tick; }
+    constexpr void set_last_run_tick(tick_t const tick) noexcept { m_last_run_tick = tick; }
 };
 
 namespace internal {
 
-    // check if a type is a `tl::optional`
-    template <typename T>
-    struct is_optional_impl : std::false_type {};
-
-    template <typename T>
-    struct is_optional_impl<tl::optional<T>> : std::true_type {};
-
-    template <typename T>
-    inline constexpr bool is_optional_v = is_optional_impl<std::remove_cvref_t<T>>::value;
-
-    // if a value is an option, return its contained value, else return the original value.
-    template <typename T>
-    requires (!is_optional_v<T>)
-    constexpr auto unwrap_optional(T&& t) -> decltype(auto)
-    {
-        return FWD(t);
-    }
-
-    template <typename O>
-    requires (is_optional_v<O>)
-    constexpr auto unwrap_optional(O&& opt)
-    {
-        return *FWD(opt);
-    }
-
-    // if a value is an optional check `has_value()`, else return true
-    template <typename T>
-    requires (!is_optional_v<T>)
-    constexpr void if_optional_check_value(T const&) {}
-
-    template <typename O>
-    requires (is_optional_v<O>)
-    constexpr void if_optional_check_value(O const& opt)
-    {
-        // TODO: perhaps panic in release mode as well?
-        DEBUG_ASSERT(opt.has_value(), "System was unable to find: '{}'.", type_name<typename O::value_type>());
-        UNUSED(opt);
-    }
-
     // checks a type to ensure its a valid system argument
     template <typename T>
     struct valid_system_arg : std::false_type {};
@@ -88,131 +59,426 @@ namespace internal {
     template <typename T>
     struct valid_system_arg<EventReader<T>> : std::true_type {};
 
-    // Depending on the argument type, returns the correct value from either the `Resources` or the `World`
+    template <typename T>
+    struct valid_system_arg<ParallelEventWriter<T>> : std::true_type {};
+
+    // The cached state of a single system argument.
+    // `resolve()` looks the argument up in either the `Resources` or the `World`. It is always run on the main thread,
+    // before the system first runs, whenever `Resources::generation()` changes and whenever the system runs with
+    // another `Resources` or `World` (told apart by `Resources::instance_id()` and `world_id()`, never by address).
+    // `fetch()` creates the argument from the cached state each time the system runs.
+    // `borrow()` / `release()` (optional) borrow the resources the argument accesses for as long as the system runs.
+    // `apply()` (optional) applies anything the argument deferred, once every system in the stage has run.
     template <typename Arg>
-    struct get_system_arg_impl;
+    struct system_param_state;
 
     template <typename VG, typename... Ws, typename... WOs>
-    struct get_system_arg_impl<Query<With<Ws...>, Without<WOs...>, VG>>
+    struct system_param_state<Query<With<Ws...>, Without<WOs...>, VG>>
     {
         using query_t = Query<With<Ws...>, Without<WOs...>, VG>;
-        auto operator()(SystemSettings const&, Resources&, World& world) const
+
+        // entt never destroys its pools (or groups), so a view only has to be created once.
+        tl::optional<typename query_t::base_t> repr;
+        TaskPool const* pool = nullptr;
+
+        template <typename W>
+        static void track_filter(Resources& res, World& world)
         {
-            if constexpr (std::is_same_v<VG, View>) {
-                return query_t{ world.view<Ws...>(entt::exclude<WOs...>) };
-            }
-            else if constexpr (std::is_same_v<VG, Group>) {
-                return query_t{ world.group<Ws...>(entt::exclude<WOs...>) };
-            }
-            else {
-                static_assert(meta::always_false<VG>::value, "Final Query<> param must be either a `View` or a `Group`");
+            if constexpr (is_change_filter<W>::value) {
+                track_changes<typename W::component_t>(world, *res.try_add_resource<ChangeTick>());
             }
         }
+
+        void resolve(SystemSettings const&, Resources& res, World& world)
+        {
+            // used by `Query::par_each`
+            pool = res.get_resource<TaskPool const>().map([](auto p) { return std::addressof(*p); }).value_or(nullptr);
+
+            (track_filter<Ws>(res, world), ...);
+            repr.emplace(query_t::create_repr(world));
+        }
+
+        auto fetch(SystemSettings& settings) const -> query_t
+        {
+            return query_t(*repr, pool, settings.last_run_tick());
+        }
     };
 
     template <typename R>
-    struct get_system_arg_impl<Resource<R>>
+    struct system_param_state<Resource<R>>
     {
-        auto operator()(SystemSettings const&, Resources& res, World&) const
+        R* resource = nullptr;
+        std::shared_ptr<resource_detail::BorrowState> borrow_state;
+
+        void resolve(SystemSettings const&, Resources& res, World&)
+        {
+            resource = res.get_resource<R>().map([](auto r) { return std::addressof(*r); }).value_or(nullptr);
+            borrow_state = res.borrow_state<R>();
+        }
+
+        void borrow() const
+        {
+            if (borrow_state) {
+                resource_detail::borrow<R>(*borrow_state);
+            }
+        }
+
+        void release() const
+        {
+            if (borrow_state) {
+                resource_detail::release<R>(*borrow_state);
+            }
+        }
+
+        auto fetch(SystemSettings&) const -> Resource<R>
         {
-            return res.get_resource<R>();
+            // TODO: perhaps panic in release mode as well?
+            DEBUG_ASSERT(resource != nullptr, "System was unable to find: '{}'.", type_name<Resource<R>>());
+            return Resource<R>(*resource);
         }
     };
 
     template <typename L>
-    struct get_system_arg_impl<Local<L>>
+    struct system_param_state<Local<L>>
     {
-        auto operator()(SystemSettings const& settings, Resources& res, World&) const
+        L* local = nullptr;
+
+        void resolve(SystemSettings const& settings, Resources& res, World&)
+        {
+            local = res.local().get_local_resource<L>(settings.id()).map([](auto l) { return std::addressof(*l); }).value_or(nullptr);
+        }
+
+        auto fetch(SystemSettings&) const -> Local<L>
         {
-            return res.local().get_local_resource<L>(settings.id());
+            DEBUG_ASSERT(local != nullptr, "System was unable to find: '{}'.", type_name<Local<L>>());
+            return make_local_resource(*local);
         }
     };
 
     template <>
-    struct get_system_arg_impl<SystemSettings>
+    struct system_param_state<SystemSettings>
     {
-        constexpr auto operator()(SystemSettings& settings, Resources&, World&) const -> decltype(auto)
+        void resolve(SystemSettings const&, Resources&, World&) {}
+
+        auto fetch(SystemSettings& settings) const -> decltype(auto)
         {
             return std::ref(settings);
         }
     };
 
     template <>
-    struct get_system_arg_impl<Commands>
+    struct system_param_state<Commands>
     {
-        constexpr auto operator()(SystemSettings const&, Resources& res, World& w) const -> Commands
+        CommandQueue* queue = nullptr;
+
+        void resolve(SystemSettings const& settings, Resources& res, World&)
+        {
+            queue = std::addressof(*res.local().try_add_local_resource<CommandQueue>(settings.id()));
+        }
+
+        auto fetch(SystemSettings&) const -> Commands
+        {
+            return Commands{ *queue };
+        }
+
+        void apply(Resources& res, World& world) const
         {
-            return Commands{ res, w };
+            if (!queue->empty()) {
+                queue->apply(res, world);
+            }
         }
     };
 
     template <typename T>
-    struct get_system_arg_impl<EventReader<T>>
+    struct system_param_state<EventReader<T>>
     {
-        auto operator()(SystemSettings const& settings, Resources& res, World&) const -> EventReader<T>
+        using count_t = typename EventReader<T>::EventCount;
+
+        Events<T> const* events = nullptr;
+        std::shared_ptr<resource_detail::BorrowState> borrow_state;
+        count_t* last_event_count = nullptr;
+
+        void resolve(SystemSettings const& settings, Resources& res, World&)
         {
-            auto events = res.get_resource<Events<T> const>();
-            DEBUG_ASSERT(events.has_value(), "Events<{}> does not exist.", type_name<T>());
+            events = res.get_resource<Events<T> const>().map([](auto e) { return std::addressof(*e); }).value_or(nullptr);
+            borrow_state = res.borrow_state<Events<T>>();
+            last_event_count = std::addressof(*res.local().try_add_local_resource<count_t>(settings.id(), count_t{ 1 }));
+        }
 
-            using count_t = typename EventReader<T>::EventCount;
-            auto const local = res.local().try_add_local_resource<count_t>(settings.id(), count_t{ 1 });
-            return EventReader<T>(local, *MOV(events));
+        void borrow() const
+        {
+            if (borrow_state) {
+                resource_detail::borrow<Events<T> const>(*borrow_state);
+            }
+        }
+
+        void release() const
+        {
+            if (borrow_state) {
+                resource_detail::release<Events<T> const>(*borrow_state);
+            }
+        }
+
+        auto fetch(SystemSettings&) const -> EventReader<T>
+        {
+            DEBUG_ASSERT(events != nullptr, "Events<{}> does not exist.", type_name<T>());
+            return EventReader<T>(make_local_resource(*last_event_count), make_const_resource(*events));
+        }
+    };
+
+    template <typename T>
+    struct system_param_state<ParallelEventWriter<T>>
+    {
+        event_detail::StagingBuffer<T>* buffer = nullptr;
+        std::shared_ptr<resource_detail::BorrowState> borrow_state;
+
+        void resolve(SystemSettings const& settings, Resources& res, World&)
+        {
+            // the lane is keyed by the system, so it survives re-resolving and keeps its place in the flush order.
+            buffer = res.get_resource<ParallelEvents<T>>()
+                .map([&settings](auto e) { return std::addressof(e->lane(settings.id().index)); })
+                .value_or(nullptr);
+            borrow_state = res.borrow_state<ParallelEvents<T>>();
+        }
+
+        // writers only append to their own lane, so any number of them can share the resource.
+        void borrow() const
+        {
+            if (borrow_state) {
+                resource_detail::borrow<ParallelEvents<T> const>(*borrow_state);
+            }
+        }
+
+        void release() const
+        {
+            if (borrow_state) {
+                resource_detail::release<ParallelEvents<T> const>(*borrow_state);
+            }
+        }
+
+        auto fetch(SystemSettings&) const -> ParallelEventWriter<T>
+        {
+            DEBUG_ASSERT(buffer != nullptr, "ParallelEvents<{}> does not exist.", type_name<T>());
+            return ParallelEventWriter<T>(*buffer);
         }
     };
 
+    // The cached state of every argument of a system.
     template <typename... Args>
-    auto get_system_args(SystemSettings& settings, Resources& res, World& world)
+    struct SystemState
     {
-        return std::make_tuple(get_system_arg_impl<Args>{}(settings, res, world)...);
-    }
+        std::tuple<system_param_state<Args>...> params;
+        std::uint64_t resources_id = 0; // `Resources::instance_id()`, never 0
+        std::uint64_t world_id = 0; // `world_id()`, never 0
+        ChangeTick* change_tick = nullptr;
+        std::size_t generation = 0;
+
+        [[nodiscard]] auto is_stale(Resources const& res, World const& w) const noexcept -> bool
+        {
+            return resources_id != res.instance_id() || world_id != find_world_id(w) || generation != res.generation();
+        }
+
+        void resolve(SystemSettings const& settings, Resources& res, World& w)
+        {
+            std::apply([&](auto&... states) { (states.resolve(settings, res, w), ...); }, params);
+            change_tick = res.get_resource<ChangeTick>().map([](auto t) { return std::addressof(*t); }).value_or(nullptr);
+
+            // resolving can add local resources, so the generation has to be read afterwards.
+            resources_id = res.instance_id();
+            world_id = ::world_id(w);
+            generation = res.generation();
+        }
+
+        // borrows every resource the system accesses, conflicting borrows panic in debug builds.
+        void borrow() const
+        {
+            auto const borrow_one = [](auto const& state) {
+                if constexpr (requires { state.borrow(); }) {
+                    state.borrow();
+                }
+            };
+            std::apply([&](auto const&... states) { (borrow_one(states), ...); }, params);
+        }
 
-    // helper function that aggregate all the system arguments, check them, and then invoke the original function
+        void release() const
+        {
+            auto const release_one = [](auto const& state) {
+                if constexpr (requires { state.release(); }) {
+                    state.release();
+                }
+            };
+            std::apply([&](auto const&... states) { (release_one(states), ...); }, params);
+        }
+
+        void apply(Resources& res, World& w) const
+        {
+            auto const apply_one = [&](auto const& state) {
+                if constexpr (requires { state.apply(res, w); }) {
+                    state.apply(res, w);
+                }
+            };
+            std::apply([&](auto const&... states) { (apply_one(states), ...); }, params);
+        }
+    };
+
+    template <typename F>
+    struct system_state;
+
+    template <typename... Args>
+    struct system_state<meta::args<Args...>>
+    {
+        using type = SystemState<std::remove_cvref_t<Args>...>;
+    };
+
+    template <typename F>
+    using system_state_t = typename system_state<typename meta::function_traits<std::remove_cvref_t<F>>::args_t>::type;
+
+    // helper function that fetches all the system arguments from the cached state, and then invokes the original function
     template <typename F, typename... Args>
-    void type_erased_system_impl(SystemSettings& settings, void const* const data, Resources& res, World& world, meta::args<Args...>)
+    void type_erased_system_impl(SystemSettings& settings, void const* const data, void* const state_ptr, Resources& res, World& world, meta::args<Args...>)
     {
         static_assert(meta::all<valid_system_arg, std::remove_cvref_t<Args>...>, "System arguments can only be a `Query<>` or `Resource<>`");
         
         auto const func = reinterpret_cast<F const*>(data);
+        auto& state = *static_cast<SystemState<std::remove_cvref_t<Args>...>*>(state_ptr);
 
-        auto args = get_system_args<std::remove_cvref_t<Args>...>(settings, res, world);
-
-        std::apply([](auto const&... xs) { (if_optional_check_value(xs), ...); }, args);
+        // resolving mutates the `Resources` and `World`, it is only done by `System::prepare` on the main thread.
+        DEBUG_ASSERT(!state.is_stale(res, world), "System '{}' was run without being prepared.", settings.id().id.name());
 
-        std::apply([func](auto&&... xs) { (*func)(unwrap_optional(FWD(xs))...); }, MOV(args));
+        auto const this_run = state.change_tick ? state.change_tick->advance() : settings.last_run_tick();
+        state.borrow();
+        std::apply([&](auto const&... states) { (*func)(states.fetch(settings)...); }, state.params);
+        state.release();
+        settings.set_last_run_tick(this_run);
     }
 
     // type erased system function that reinterprets the function pointer to the original type
     template <typename F>
-    void type_erased_system(SystemSettings& settings, void const* const data, Resources& resources, World& world)
+    void type_erased_system(SystemSettings& settings, void const* const data, void* const state, Resources& resources, World& world)
     {
         using Func = std::remove_cvref_t<F>;
         using func_traits = meta::function_traits<Func>;
         static_assert(std::is_same_v<void, typename func_traits::result_t>, "Systems must return `void`");
 
-        type_erased_system_impl<Func>(settings, data, resources, world, typename func_traits::args_t{});
+        type_erased_system_impl<Func>(settings, data, state, resources, world, typename func_traits::args_t{});
+    }
+
+    using type_erased_system_t = void(*)(SystemSettings&, void const*, void*, Resources&, World&);
+
+    // returns true if the state had to be resolved.
+    template <typename F>
+    auto type_erased_prepare_system(SystemSettings& settings, void* const state_ptr, Resources& resources, World& world) -> bool
+    {
+        auto& state = *static_cast<system_state_t<F>*>(state_ptr);
+        if (!state.is_stale(resources, world)) {
+            return false;
+        }
+        state.resolve(settings, resources, world);
+        return true;
     }
 
-    using type_erased_system_t = void(*)(SystemSettings&, void const*, Resources&, World&);
+    using type_erased_prepare_system_t = bool(*)(SystemSettings&, void*, Resources&, World&);
+
+    template <typename F>
+    void type_erased_apply_system(void* const state_ptr, Resources& resources, World& world)
+    {
+        static_cast<system_state_t<F>*>(state_ptr)->apply(resources, world);
+    }
+
+    using type_erased_apply_system_t = void(*)(void*, Resources&, World&);
+
+    // releases the index of the system's id once the system is dropped, so the next system created reuses it.
+    class SystemIdOwner
+    {
+        SystemId m_id;
+        bool m_owned = true;
+
+        void release() noexcept
+        {
+            if (std::exchange(m_owned, false)) {
+                SystemId::release(m_id);
+            }
+        }
+
+    public:
+        explicit SystemIdOwner(SystemId const id) noexcept : m_id(id) {}
+
+        SystemIdOwner(SystemIdOwner&& other) noexcept
+            : m_id(other.m_id)
+            , m_owned(std::exchange(other.m_owned, false))
+        {}
+
+        SystemIdOwner& operator=(SystemIdOwner&& other) noexcept
+        {
+            if (this != std::addressof(other)) {
+                release();
+                m_id = other.m_id;
+                m_owned = std::exchange(other.m_owned, false);
+            }
+            return *this;
+        }
+
+        ~SystemIdOwner() { release(); }
+    };
 
 } // namespace internal
 
+// Names a group of systems so that other systems in the same stage can be ordered relative to it.
+struct SystemLabel
+{
+    type_id_t id;
+
+    constexpr SystemLabel(type_id_t const id) noexcept : id(id) {}
+
+    template <typename LabelTag>
+    constexpr static auto create() noexcept -> SystemLabel
+    {
+        return SystemLabel{ type_id<std::remove_cvref_t<LabelTag>>() };
+    }
+
+    constexpr auto operator==(SystemLabel const& rhs) const noexcept -> bool
+    {
+        return id == rhs.id;
+    }
+
+    constexpr auto operator!=(SystemLabel const& rhs) const noexcept -> bool
+    {
+        return !(*this == rhs);
+    }
+};
+
 class System 
 {
     using run_func_t = internal::type_erased_system_t;
+    using prepare_func_t = internal::type_erased_prepare_system_t;
+    using apply_func_t = internal::type_erased_apply_system_t;
 
     run_func_t m_run_func;
+    prepare_func_t m_prepare_func;
+    apply_func_t m_apply_func;
     void const* m_data = nullptr;
+    void_ptr m_state;
     SystemSettings m_settings;
+    internal::SystemIdOwner m_id_owner;
+    SystemAccess m_access;
+    std::vector<SystemLabel> m_labels;
+    std::vector<SystemLabel> m_before;
+    std::vector<SystemLabel> m_after;
 
-    System(run_func_t const run_func, void const* const data, SystemId const id) noexcept
+    System(run_func_t const run_func, prepare_func_t const prepare_func, apply_func_t const apply_func, void const* const data, void_ptr state, SystemId const id, SystemAccess access) noexcept
         : m_run_func(run_func)
+        , m_prepare_func(prepare_func)
+        , m_apply_func(apply_func)
         , m_data(data)
+        , m_state(MOV(state))
         , m_settings(id, true)
+        , m_id_owner(id)
+        , m_access(MOV(access))
     {}
 
 public:
-    constexpr System(System&&) noexcept = default;
-    constexpr System& operator=(System&&) noexcept = default;
+    System(System&&) noexcept = default;
+    System& operator=(System&&) noexcept = default;
 
     template <typename F>
     requires (!std::is_rvalue_reference_v<F>)
@@ -220,15 +486,67 @@ public:
     {
         auto const id = SystemId::create<F>();
         auto const run_func = internal::type_erased_system<F>;
-        return System(run_func, reinterpret_cast<void const*>(std::addressof(f)), id);
+        auto const prepare_func = internal::type_erased_prepare_system<F>;
+        auto const apply_func = internal::type_erased_apply_system<F>;
+        auto state = void_ptr::create<internal::system_state_t<F>>();
+        auto access = internal::make_system_access(typename meta::function_traits<std::remove_cvref_t<F>>::args_t{});
+        return System(run_func, prepare_func, apply_func, reinterpret_cast<void const*>(std::addressof(f)), MOV(state), id, MOV(access));
+    }
+
+    // resolves the system's arguments if they have not been yet, or if the `Resources` have changed since.
+    // returns true if they had to be resolved. Must be called on the main thread.
+    auto prepare(Resources& resources, World& world) -> bool
+    {
+        return m_prepare_func(m_settings, m_state.data(), resources, world);
     }
 
-    constexpr void run(Resources& resources, World& world)
+    // prepares the system on the calling thread, then runs it.
+    void run(Resources& resources, World& world)
     {
-        m_run_func(m_settings, m_data, resources, world);
+        prepare(resources, world);
+        run_prepared(resources, world);
+    }
+
+    // runs a system whose arguments are up to date (see `prepare`), safe to call from any thread.
+    void run_prepared(Resources& resources, World& world)
+    {
+        m_run_func(m_settings, m_data, m_state.data(), resources, world);
+    }
+
+    // applies the deferred `Commands` of the system.
+    void apply(Resources& resources, World& world)
+    {
+        m_apply_func(m_state.data(), resources, world);
     }
 
     constexpr auto id() const noexcept -> SystemId { return m_settings.id(); }
 
     constexpr auto should_run() const noexcept -> bool { return m_settings.should_run(); }
+
+    auto access() const noexcept -> SystemAccess const& { return m_access; }
+
+    // ordering, only applies to systems in the same stage.
+    auto label(SystemLabel const label) -> System&
+    {
+        m_labels.push_back(label);
+        return *this;
+    }
+
+    // runs this system before every system labeled with `label`.
+    auto before(SystemLabel const label) -> System&
+    {
+        m_before.push_back(label);
+        return *this;
+    }
+
+    // runs this system after every system labeled with `label`.
+    auto after(SystemLabel const label) -> System&
+    {
+        m_after.push_back(label);
+        return *this;
+    }
+
+    auto labels() const noexcept -> std::vector<SystemLabel> const& { return m_labels; }
+    auto before_labels() const noexcept -> std::vector<SystemLabel> const& { return m_before; }
+    auto after_labels() const noexcept -> std::vector<SystemLabel> const& { return m_after; }
 };
\ No newline at end of file
@@ -1,15 +1,60 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <vector>
 #include <entt/entt.hpp>
 
-template<typename Entity, typename Type>
-struct entt::storage_traits<Entity, Type> {
-    // prevents entt:: from using its internal signals.
-    using storage_type = storage_adapter_mixin<basic_storage<Entity, Type>>;
-};
-
 using World = entt::registry;
 
 using entity_t = entt::entity;
 
-inline constexpr auto null_entity = entt::null;
\ No newline at end of file
+inline constexpr auto null_entity = entt::null;
+
+// Grows the storage of every `Cs` up front, so that `additional` components can be inserted without reallocating.
+template <typename... Cs>
+void reserve_components(World& world, std::size_t const additional)
+{
+    (world.reserve<Cs>(world.view<Cs const>().size() + additional), ...);
+}
+
+// Inserts `make(i)` for every `entities[i]` with a single bulk insert into `T`'s storage.
+template <typename T, typename F>
+void insert_components(World& world, std::span<entity_t const> const entities, F&& make)
+{
+    auto values = std::vector<T>();
+    values.reserve(entities.size());
+    for (std::size_t i = 0; i < entities.size(); ++i) {
+        values.push_back(make(i));
+    }
+    world.insert<T>(entities.begin(), entities.end(), std::make_move_iterator(values.begin()));
+}
+
+namespace world_detail {
+
+    struct WorldId
+    {
+        std::uint64_t value;
+    };
+
+} // namespace world_detail
+
+// Unique for every `World` that has been asked for its id, `0` if it never was (see `world_id()`).
+// The id lives in the world's context, so it moves along with the world's storages.
+[[nodiscard]] inline auto find_world_id(World const& world) -> std::uint64_t
+{
+    auto const* const id = world.ctx().find<world_detail::WorldId>();
+    return id ? id->value : 0;
+}
+
+[[nodiscard]] inline auto world_id(World& world) -> std::uint64_t
+{
+    static std::atomic<std::uint64_t> next_id{ 1 };
+    if (auto const id = find_world_id(world); id != 0) {
+        return id;
+    }
+    return world.ctx().emplace<world_detail::WorldId>(next_id.fetch_add(1, std::memory_order_relaxed)).value;
+}
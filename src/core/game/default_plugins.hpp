@@ -6,6 +6,7 @@
 #include <core/input/plugin.hpp>
 #include <core/render/plugin.hpp>
 #include <core/sprite/plugin.hpp>
+#include <core/time/plugin.hpp>
 #include <core/window/plugin.hpp>
 #include <sdl/plugin.hpp>
 
@@ -14,6 +15,7 @@ struct DefaultPlugins
     void build(GameBuilder& builder)
     {
         builder
+            .add_plugin(TimePlugin{})
             .add_plugin(InputPlugin{})
             .add_plugin(AssetPlugin{})
             .add_plugin(WindowPlugin{})
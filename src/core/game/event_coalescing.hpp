@@ -0,0 +1,90 @@
+#pragma once
+
+#include <core/ecs/resource.hpp>
+#include <core/game/events.hpp>
+#include <debug/debug.hpp>
+#include <tl/optional.hpp>
+#include <util/common.hpp>
+
+#include <concepts>
+#include <memory>
+#include <utility>
+
+// An event type that can be coalesced provides `try_coalesce(T& into, T const& next) -> bool`, found through ADL.
+// It merges `next` into `into`, or returns false (leaving both untouched) if they can not be merged.
+template <typename T>
+concept CoalescableEvent = requires(T& into, T const& next)
+{
+    { try_coalesce(into, next) } -> std::same_as<bool>;
+};
+
+// Opts `T` into coalescing, e.g. `builder.set_resource<CoalesceEvents<MouseMotion>>()`.
+// Platform events of type `T` received in one poll are then merged into as few events as possible.
+template <CoalescableEvent T>
+struct CoalesceEvents {};
+
+// Sends into `Events<T>`, merging consecutive events while coalescing is enabled.
+// The last event is held back until it can no longer be merged, `flush()` (or the destructor) sends it.
+template <typename T>
+class CoalescingEventWriter
+{
+    Events<T>* m_events = nullptr;
+    bool m_coalesce = false;
+    tl::optional<T> m_pending = tl::nullopt;
+
+public:
+    constexpr CoalescingEventWriter(Events<T>* const events, bool const coalesce) noexcept
+        : m_events(events)
+        , m_coalesce(coalesce)
+    {}
+
+    // resolves `Events<T>` and whether `T` has opted into coalescing.
+    static auto create(Resources& resources) -> CoalescingEventWriter
+    {
+        auto const events = resources.get_resource<Events<T>>().map([](auto e) { return std::addressof(*e); }).value_or(nullptr);
+        if constexpr (CoalescableEvent<T>) {
+            return CoalescingEventWriter(events, resources.contains_resource<CoalesceEvents<T>>());
+        }
+        else {
+            return CoalescingEventWriter(events, false);
+        }
+    }
+
+    CoalescingEventWriter(CoalescingEventWriter const&) = delete;
+    CoalescingEventWriter& operator=(CoalescingEventWriter const&) = delete;
+
+    ~CoalescingEventWriter()
+    {
+        flush();
+    }
+
+    [[nodiscard]] constexpr auto is_coalescing() const noexcept -> bool
+    {
+        return m_coalesce;
+    }
+
+    void send(T value)
+    {
+        DEBUG_ASSERT(m_events != nullptr, "Events<{}> does not exist.", type_name<T>());
+
+        if constexpr (CoalescableEvent<T>) {
+            if (m_coalesce) {
+                if (!m_pending.has_value() || !try_coalesce(*m_pending, std::as_const(value))) {
+                    flush();
+                    m_pending = MOV(value);
+                }
+                return;
+            }
+        }
+
+        m_events->send(MOV(value));
+    }
+
+    void flush()
+    {
+        if (m_pending.has_value()) {
+            m_events->send(MOV(*m_pending));
+            m_pending.reset();
+        }
+    }
+};
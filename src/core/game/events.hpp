@@ -2,10 +2,16 @@
 
 #include <debug/debug.hpp>
 #include <core/ecs/resource.hpp>
+#include <algorithm>
+#include <array>
+#include <concepts>
 #include <iterator>
+#include <tl/optional.hpp>
 #include <util/common.hpp>
 #include <util/ranges/chain.hpp>
 #include <ranges>
+#include <span>
+#include <type_traits>
 #include <vector>
 
 template <typename T>
@@ -33,6 +39,10 @@ struct Event
 template <typename T>
 class ManualEventReader;
 
+// the unread events as (at most) two contiguous segments, the older one first.
+template <typename T>
+using EventSpans = std::array<std::span<Event<T> const>, 2>;
+
 namespace event_detail {
     template <typename T>
     constexpr auto map_instance_event_with_id(Event<T> const& event) noexcept -> std::tuple<EventId<T>, T const&>
@@ -62,6 +72,21 @@ class Events
     std::size_t m_event_count = 0;
     State m_state = State::A;
 
+    // buffers are cleared but keep their capacity across updates. when set, they are
+    // released after this many consecutive updates without any new events.
+    tl::optional<std::size_t> m_shrink_after_quiet_updates = tl::nullopt;
+    std::size_t m_quiet_updates = 0;
+
+    [[nodiscard]] constexpr auto current_events() noexcept -> std::vector<Event<T>>&
+    {
+        return m_state == State::A ? m_a_events : m_b_events;
+    }
+
+    [[nodiscard]] constexpr auto current_start_event_count() const noexcept -> std::size_t
+    {
+        return m_state == State::A ? m_a_start_event_count : m_b_start_event_count;
+    }
+
     template <typename F>
     auto internal_event_reader(std::size_t& last_event_count, F&& f) const noexcept
     {
@@ -83,6 +108,36 @@ class Events
         }
     }
 
+    auto internal_event_spans(std::size_t& last_event_count) const noexcept -> EventSpans<T>
+    {
+        auto const unread = [last_event_count](std::vector<Event<T>> const& events, std::size_t const start_event_count) {
+            auto const index = std::min(last_event_count > start_event_count ? last_event_count - start_event_count : 0, events.size());
+            return std::span<Event<T> const>(events).subspan(index);
+        };
+
+        last_event_count = m_event_count;
+
+        auto const a_span = unread(m_a_events, m_a_start_event_count);
+        auto const b_span = unread(m_b_events, m_b_start_event_count);
+
+        switch (m_state) {
+            case State::A:
+                return { b_span, a_span };
+            default: // State::B
+                return { a_span, b_span };
+        }
+    }
+
+    template <typename F>
+    static void for_each_batch(EventSpans<T> const& spans, F&& f)
+    {
+        for (auto const span : spans) {
+            if (!span.empty()) {
+                f(span);
+            }
+        }
+    }
+
     template <typename>
     friend class ManualEventReader;
     template <typename>
@@ -93,18 +148,7 @@ public:
     void send(Args&&... args)
     {
         auto const id = EventId<T>{ .id = m_event_count };
-
-        switch (m_state) {
-            case State::A: 
-                m_a_events.emplace_back(id, FWD(args)...);
-                break;
-            case State::B: 
-                m_b_events.emplace_back(id, FWD(args)...);
-                break;
-            default: // unreachable
-                break;
-        }
-
+        current_events().emplace_back(id, FWD(args)...);
         ++m_event_count;
     }
 
@@ -112,12 +156,57 @@ public:
     requires std::sentinel_for<Sent, It>
     void send_batch(It it, Sent const sent)
     {
+        auto& events = current_events();
+
+        if constexpr (std::sized_sentinel_for<Sent, It> || std::forward_iterator<It>) {
+            auto const count = static_cast<std::size_t>(std::ranges::distance(it, sent));
+            auto const required = events.size() + count;
+            // keep geometric growth so repeated batches stay amortized O(1) per event.
+            if (required > events.capacity()) {
+                events.reserve(std::max(required, events.capacity() * 2));
+            }
+        }
+
         while (it != sent) {
-            send(*it);
+            events.emplace_back(EventId<T>{ .id = m_event_count }, *it);
+            ++m_event_count;
             std::advance(it, 1);
         }
     }
 
+    // releases the buffers after `updates` consecutive updates without new events.
+    // tl::nullopt (the default) keeps the high-water-mark capacity indefinitely.
+    constexpr void set_shrink_after_quiet_updates(tl::optional<std::size_t> const updates) noexcept
+    {
+        m_shrink_after_quiet_updates = updates;
+    }
+
+    [[nodiscard]] constexpr auto shrink_after_quiet_updates() const noexcept -> tl::optional<std::size_t>
+    {
+        return m_shrink_after_quiet_updates;
+    }
+
+    [[nodiscard]] constexpr auto capacity() const noexcept -> std::size_t
+    {
+        return m_a_events.capacity() + m_b_events.capacity();
+    }
+
+    [[nodiscard]] constexpr auto len() const noexcept -> std::size_t
+    {
+        return m_a_events.size() + m_b_events.size();
+    }
+
+    [[nodiscard]] constexpr auto is_empty() const noexcept -> bool
+    {
+        return m_a_events.empty() && m_b_events.empty();
+    }
+
+    void shrink_to_fit()
+    {
+        m_a_events.shrink_to_fit();
+        m_b_events.shrink_to_fit();
+    }
+
     // includes all events already in the event buffers.
     constexpr auto get_reader() const noexcept -> ManualEventReader<T>;
 
@@ -126,15 +215,21 @@ public:
 
     void update() 
     { 
+        if (m_event_count == current_start_event_count()) {
+            ++m_quiet_updates;
+        } else {
+            m_quiet_updates = 0;
+        }
+
         switch (m_state) {
             case State::A: {
-                std::vector<Event<T>>().swap(m_b_events);
+                m_b_events.clear();
                 m_state = State::B;
                 m_b_start_event_count = m_event_count;
             }
                 break;
             case State::B: {
-                std::vector<Event<T>>().swap(m_a_events);
+                m_a_events.clear();
                 m_state = State::A;
                 m_a_start_event_count = m_event_count;
             }
@@ -142,6 +237,12 @@ public:
             default: // unreachable
                 break;
         }
+
+        if (m_quiet_updates > 0 && m_shrink_after_quiet_updates == m_quiet_updates) {
+            // both buffers are empty after enough quiet updates; release their storage.
+            std::vector<Event<T>>().swap(m_a_events);
+            std::vector<Event<T>>().swap(m_b_events);
+        }
     }
 
     void clear() 
@@ -151,6 +252,10 @@ public:
     }
 };
 
+// label of `events_update_system<T>`, systems that send into `Events<T>` at the end of a frame run before it.
+template <typename T>
+struct EventsUpdate {};
+
 template <typename T>
 void events_update_system(Resource<Events<T>> events)
 {
@@ -181,6 +286,20 @@ public:
     {
         return events.internal_event_reader(m_last_event_count, event_detail::map_instance_event<T>);
     }
+
+    // contiguous alternative to `iter`, for consumers that want tight (or vectorized) loops.
+    auto spans(Events<T> const& events) noexcept -> EventSpans<T>
+    {
+        return events.internal_event_spans(m_last_event_count);
+    }
+
+    // calls `f` with each non-empty `std::span<Event<T> const>` of unread events, oldest first.
+    template <typename F>
+    requires std::invocable<F&, std::span<Event<T> const>>
+    void for_each_batch(Events<T> const& events, F&& f) noexcept(std::is_nothrow_invocable_v<F&, std::span<Event<T> const>>)
+    {
+        Events<T>::for_each_batch(spans(events), f);
+    }
 };
 
 template <typename T>
@@ -214,6 +333,20 @@ public:
     {
         return m_events->internal_event_reader(m_last_event_count->count, event_detail::map_instance_event<T>);
     }
+
+    // contiguous alternative to `iter`, for consumers that want tight (or vectorized) loops.
+    auto spans() noexcept -> EventSpans<T>
+    {
+        return m_events->internal_event_spans(m_last_event_count->count);
+    }
+
+    // calls `f` with each non-empty `std::span<Event<T> const>` of unread events, oldest first.
+    template <typename F>
+    requires std::invocable<F&, std::span<Event<T> const>>
+    void for_each_batch(F&& f) noexcept(std::is_nothrow_invocable_v<F&, std::span<Event<T> const>>)
+    {
+        Events<T>::for_each_batch(spans(), f);
+    }
 };
 
 template <typename T>
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+// Frame times the runner achieved over the most recent `window` frames.
+class FrameStats
+{
+public:
+    using dur_t = std::chrono::duration<double>;
+    static constexpr std::size_t window = 240;
+
+private:
+    std::array<double, window> m_samples{};
+    std::size_t m_count = 0;
+    std::size_t m_head = 0;
+    double m_sum = 0.0;
+    double m_sum_sq = 0.0;
+    std::uint64_t m_frames = 0;
+    std::uint64_t m_missed_deadlines = 0;
+
+public:
+    // `missed` is set if the frame finished its work after its deadline.
+    void record(dur_t const frame_time, bool const missed) noexcept
+    {
+        auto const sample = frame_time.count();
+        if (m_count == window) {
+            auto const old = m_samples[m_head];
+            m_sum -= old;
+            m_sum_sq -= old * old;
+        }
+        else {
+            ++m_count;
+        }
+
+        m_samples[m_head] = sample;
+        m_head = (m_head + 1) % window;
+        m_sum += sample;
+        m_sum_sq += sample * sample;
+
+        ++m_frames;
+        if (missed) {
+            ++m_missed_deadlines;
+        }
+    }
+
+    [[nodiscard]] auto mean() const noexcept -> dur_t
+    {
+        return dur_t(m_count > 0 ? m_sum / static_cast<double>(m_count) : 0.0);
+    }
+
+    [[nodiscard]] auto stddev() const noexcept -> dur_t
+    {
+        if (m_count < 2) {
+            return dur_t::zero();
+        }
+        auto const n = static_cast<double>(m_count);
+        auto const mean = m_sum / n;
+        return dur_t(std::sqrt(std::max(0.0, m_sum_sq / n - mean * mean)));
+    }
+
+    [[nodiscard]] auto frames() const noexcept -> std::uint64_t { return m_frames; }
+    [[nodiscard]] auto missed_deadlines() const noexcept -> std::uint64_t { return m_missed_deadlines; }
+};
+
+// Waits for frame deadlines more precisely than `std::this_thread::sleep_for`, which tends to overshoot by a millisecond or two.
+// Sleeps in coarse slices until the deadline is within the spin threshold, and then spins for the rest.
+// The threshold follows the largest sleep overshoot that has been observed, so it adapts to the scheduler it runs on.
+class FramePacer
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+    using dur_t = clock_t::duration;
+
+    static constexpr auto min_spin_threshold = dur_t(std::chrono::microseconds(200));
+    static constexpr auto max_spin_threshold = dur_t(std::chrono::milliseconds(4));
+
+private:
+    dur_t m_spin_threshold = std::chrono::milliseconds(2);
+    dur_t m_max_overshoot = dur_t::zero();
+
+    void calibrate(dur_t const overshoot) noexcept
+    {
+        // decays slowly, so that a single late wake up does not keep the threshold high forever.
+        m_max_overshoot = std::max(overshoot, m_max_overshoot - m_max_overshoot / 64);
+        m_spin_threshold = std::clamp(m_max_overshoot + m_max_overshoot / 4, min_spin_threshold, max_spin_threshold);
+    }
+
+public:
+    [[nodiscard]] auto spin_threshold() const noexcept -> dur_t { return m_spin_threshold; }
+
+    void wait_until(clock_t::time_point const deadline)
+    {
+        for (auto now = clock_t::now(); deadline - now > m_spin_threshold; now = clock_t::now()) {
+            auto const slice = (deadline - now) - m_spin_threshold;
+            std::this_thread::sleep_for(slice);
+            auto const overshoot = clock_t::now() - (now + slice);
+            calibrate(std::max(overshoot, dur_t::zero()));
+        }
+
+        while (clock_t::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+};
@@ -2,10 +2,12 @@
 
 #include <core/assets/asset_server.hpp>
 #include <core/game/events.hpp>
+#include <core/game/parallel_events.hpp>
 #include <debug/debug.hpp>
 #include <core/ecs/resource.hpp>
 #include <core/ecs/world.hpp>
 #include <core/ecs/scheduler.hpp>
+#include <core/task/task_pool.hpp>
 #include <functional>
 #include <type_traits>
 
@@ -15,6 +17,7 @@ namespace CoreStages {
     struct PreEvents {};
     struct Events {};
     struct PreUpdate {};
+    struct FixedUpdate {}; // added by `TimePlugin`, runs zero or more times per frame
     struct Update {};
     struct PostUpdate {};
 
@@ -59,6 +62,7 @@ public:
     {
         add_default_stages();
         add_event<GameExit>();
+        try_add_resource<TaskPool>(); // used to run non-conflicting systems in parallel
     }
 
     GameBuilder(Game&& game) noexcept
@@ -90,7 +94,18 @@ public:
     auto add_event() -> GameBuilder&
     {
         return try_add_resource<Events<T>>()
-            .template add_system_to_stage<CoreStages::Events>(events_update_system<T>);
+            .template add_system_to_stage<CoreStages::Events>(events_update_system<T>)
+            .template label<EventsUpdate<T>>();
+    }
+
+    // events that can also be sent through `ParallelEventWriter<T>`, from any number of systems and threads at once.
+    template <typename T>
+    auto add_parallel_event() -> GameBuilder&
+    {
+        return add_event<T>()
+            .template try_add_resource<ParallelEvents<T>>()
+            .template add_system_to_stage<CoreStages::Events>(parallel_events_flush_system<T>)
+            .template before<EventsUpdate<T>>();
     }
 
     // plugins
@@ -109,25 +124,26 @@ public:
         return *this;
     }
 
-    template <typename StageT>
+    // `StageType` can be a type derived from `Stage`, e.g. `FixedTimestepStage`.
+    template <typename StageT, typename StageType = Stage>
     auto add_stage() -> GameBuilder&
     {
-        m_game.scheduler.add_stage<StageT>();
+        m_game.scheduler.add_stage<StageT, StageType>();
         return *this;
     }
 
-    template <typename StageT, typename StageBefore>
+    template <typename StageT, typename StageBefore, typename StageType = Stage>
     auto add_stage_before() -> GameBuilder&
     {
-        m_game.scheduler.add_stage_before<StageT, StageBefore>();
+        m_game.scheduler.add_stage_before<StageT, StageBefore, StageType>();
         return *this;
     }
 
 
-    template <typename StageT, typename StageAfter>
+    template <typename StageT, typename StageAfter, typename StageType = Stage>
     auto add_stage_after() -> GameBuilder&
     {
-        m_game.scheduler.add_stage_after<StageT, StageAfter>();
+        m_game.scheduler.add_stage_after<StageT, StageAfter, StageType>();
         return *this;
     }
 
@@ -171,6 +187,29 @@ public:
         return *this;
     }
 
+    // ordering of the last added system, relative to the systems of its stage carrying a label.
+    // e.g. `builder.add_system(movement_system).label<Movement>().after<Input>()`
+    template <typename LabelTag>
+    auto label() -> GameBuilder&
+    {
+        m_game.scheduler.last_added_system().label(SystemLabel::create<LabelTag>());
+        return *this;
+    }
+
+    template <typename LabelTag>
+    auto before() -> GameBuilder&
+    {
+        m_game.scheduler.last_added_system().before(SystemLabel::create<LabelTag>());
+        return *this;
+    }
+
+    template <typename LabelTag>
+    auto after() -> GameBuilder&
+    {
+        m_game.scheduler.last_added_system().after(SystemLabel::create<LabelTag>());
+        return *this;
+    }
+
     // components
     template <typename... Cs>
     auto prepare_components() -> GameBuilder&
@@ -214,6 +253,7 @@ public:
     // build
     auto build() && -> Game
     {
+        m_game.scheduler.build();
         return MOV(m_game);
     }
 };
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <tl/optional.hpp>
+#include <core/assets/plugin.hpp>
+#include <core/game/game.hpp>
+#include <core/game/runner.hpp>
+#include <core/input/plugin.hpp>
+#include <core/time/plugin.hpp>
+
+// The plugins of `DefaultPlugins` that need neither a display nor an audio device, for dedicated servers and benchmarks.
+// Instead of the SDL runner, the game runs in a `SchedulerRunnerPlugin` loop at `tick_rate` ticks per second,
+// or as fast as it can if there is no tick rate (or it is not positive). A `SchedulerRunnerSettings` resource set beforehand
+// takes precedence.
+struct HeadlessPlugins
+{
+    tl::optional<double> tick_rate = 60.0;
+
+    void build(GameBuilder& builder) const
+    {
+        auto const settings = tick_rate && *tick_rate > 0.0
+            ? SchedulerRunnerSettings::run_loop(std::chrono::duration<float>(1.0 / *tick_rate))
+            : SchedulerRunnerSettings{};
+
+        builder
+            .try_add_resource<SchedulerRunnerSettings>(settings)
+            .add_plugin(TimePlugin{})
+            .add_plugin(InputPlugin{})
+            .add_plugin(AssetPlugin{})
+            .add_plugin(SchedulerRunnerPlugin{});
+    }
+};
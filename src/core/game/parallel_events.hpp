@@ -0,0 +1,235 @@
+#pragma once
+
+#include <core/ecs/resource.hpp>
+#include <core/game/events.hpp>
+#include <debug/debug.hpp>
+#include <util/common.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace event_detail {
+
+    // Append-only buffer that any number of threads can push into without locking.
+    // A slot is reserved with a single `fetch_add` and storage grows in blocks that double in size and never move,
+    // so a push never invalidates a slot another thread is writing to. Draining requires that nothing is pushing.
+    template <typename T>
+    class StagingBuffer
+    {
+        static_assert(std::is_nothrow_move_constructible_v<T>, "Staged events are moved into their slot, which must not throw");
+
+        static constexpr std::size_t first_block_size = 64;
+        static constexpr std::size_t max_blocks = 32;
+
+        std::array<std::atomic<T*>, max_blocks> m_blocks = {};
+        std::atomic<std::size_t> m_len = 0;
+
+        static constexpr auto block_size(std::size_t const block) noexcept -> std::size_t
+        {
+            return first_block_size << block;
+        }
+
+        // block `b` holds the slots [first_block_size * (2^b - 1), first_block_size * (2^(b + 1) - 1)).
+        static constexpr auto locate(std::size_t const index) noexcept -> std::pair<std::size_t, std::size_t>
+        {
+            auto const block = static_cast<std::size_t>(std::bit_width(index / first_block_size + 1)) - 1;
+            return { block, index - first_block_size * ((std::size_t{ 1 } << block) - 1) };
+        }
+
+        static auto allocate_block(std::size_t const block) -> T*
+        {
+            return static_cast<T*>(::operator new(block_size(block) * sizeof(T), std::align_val_t{ alignof(T) }));
+        }
+
+        static void deallocate_block(T* const ptr) noexcept
+        {
+            ::operator delete(ptr, std::align_val_t{ alignof(T) });
+        }
+
+        // the first thread to reach an unallocated block publishes it, everyone else frees their copy.
+        auto acquire_block(std::size_t const block) -> T*
+        {
+            auto* ptr = m_blocks[block].load(std::memory_order_acquire);
+            if (ptr != nullptr) {
+                return ptr;
+            }
+
+            auto* const fresh = allocate_block(block);
+            if (m_blocks[block].compare_exchange_strong(ptr, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return fresh;
+            }
+
+            deallocate_block(fresh);
+            return ptr;
+        }
+
+        auto slot(std::size_t const index) const noexcept -> T*
+        {
+            auto const [block, offset] = locate(index);
+            return m_blocks[block].load(std::memory_order_relaxed) + offset;
+        }
+
+    public:
+        StagingBuffer() = default;
+
+        StagingBuffer(StagingBuffer const&) = delete;
+        StagingBuffer& operator=(StagingBuffer const&) = delete;
+
+        ~StagingBuffer()
+        {
+            clear();
+            for (auto& block : m_blocks) {
+                if (auto* const ptr = block.load(std::memory_order_relaxed); ptr != nullptr) {
+                    deallocate_block(ptr);
+                }
+            }
+        }
+
+        void push(T&& value)
+        {
+            auto const index = m_len.fetch_add(1, std::memory_order_relaxed);
+            auto const [block, offset] = locate(index);
+            DEBUG_ASSERT(block < max_blocks, "Too many events staged for '{}'.", type_name<T>());
+            std::construct_at(acquire_block(block) + offset, MOV(value));
+        }
+
+        [[nodiscard]] auto len() const noexcept -> std::size_t
+        {
+            return m_len.load(std::memory_order_acquire);
+        }
+
+        [[nodiscard]] auto is_empty() const noexcept -> bool
+        {
+            return len() == 0;
+        }
+
+        // moves every staged value into `f` in the order their slots were reserved, the blocks are kept for reuse.
+        template <typename F>
+        void drain(F&& f)
+        {
+            auto const count = m_len.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i < count; ++i) {
+                auto* const value = slot(i);
+                f(MOV(*value));
+                std::destroy_at(value);
+            }
+            m_len.store(0, std::memory_order_release);
+        }
+
+        void clear()
+        {
+            drain([](T&&) {});
+        }
+    };
+
+} // namespace event_detail
+
+// Sends `T` events from any thread, including the workers of `Query::par_each`.
+// Events are staged per writer and moved into `Events<T>` at the `CoreStages::Events` boundary.
+template <typename T>
+class ParallelEventWriter
+{
+    event_detail::StagingBuffer<T>* m_buffer;
+
+public:
+    explicit constexpr ParallelEventWriter(event_detail::StagingBuffer<T>& buffer) noexcept
+        : m_buffer(std::addressof(buffer))
+    {}
+
+    template <typename... Args>
+    void send(Args&&... args) const
+    {
+        m_buffer->push(T(FWD(args)...));
+    }
+
+    template <typename It, typename Sent>
+    requires std::sentinel_for<Sent, It>
+    void send_batch(It it, Sent const sent) const
+    {
+        while (it != sent) {
+            send(*it);
+            std::advance(it, 1);
+        }
+    }
+};
+
+// Staging area for `ParallelEventWriter<T>`, added by `GameBuilder::add_parallel_event<T>()`.
+// Every writer owns a lane, a system's lane is keyed by its `SystemId` index. Lanes are flushed in order of their key,
+// and each lane in the order its events were sent, so the `EventId`s do not depend on how the systems were scheduled.
+// Events sent to the same lane from several threads at once are kept, but their relative order is unspecified.
+template <typename T>
+class ParallelEvents
+{
+    struct Lane
+    {
+        std::size_t key;
+        event_detail::StagingBuffer<T> buffer;
+
+        explicit Lane(std::size_t const key) noexcept : key(key) {}
+    };
+
+    // sorted by `Lane::key`, lanes are never removed so the buffers stay at a stable address.
+    std::vector<std::unique_ptr<Lane>> m_lanes;
+    // only taken when looking up a lane, sending never locks.
+    std::mutex mutable m_mutex;
+
+public:
+    ParallelEvents() = default;
+
+    ParallelEvents(ParallelEvents const&) = delete;
+    ParallelEvents& operator=(ParallelEvents const&) = delete;
+
+    // the lane for `key`, created if it does not exist yet.
+    auto lane(std::size_t const key) -> event_detail::StagingBuffer<T>&
+    {
+        auto const lock = std::scoped_lock(m_mutex);
+        auto const iter = std::ranges::lower_bound(m_lanes, key, {}, [](auto const& lane) { return lane->key; });
+        if (iter != m_lanes.end() && (*iter)->key == key) {
+            return (*iter)->buffer;
+        }
+
+        return (*m_lanes.insert(iter, std::make_unique<Lane>(key)))->buffer;
+    }
+
+    auto writer(std::size_t const key) -> ParallelEventWriter<T>
+    {
+        return ParallelEventWriter<T>(lane(key));
+    }
+
+    [[nodiscard]] auto len() const -> std::size_t
+    {
+        auto const lock = std::scoped_lock(m_mutex);
+        auto count = std::size_t{ 0 };
+        for (auto const& lane : m_lanes) {
+            count += lane->buffer.len();
+        }
+        return count;
+    }
+
+    // moves every staged event into `events`, nothing may be sending while this runs.
+    void flush(Events<T>& events)
+    {
+        auto const lock = std::scoped_lock(m_mutex);
+        for (auto const& lane : m_lanes) {
+            lane->buffer.drain([&events](T&& value) { events.send(MOV(value)); });
+        }
+    }
+};
+
+// runs in `CoreStages::Events` before `events_update_system<T>`, so the staged events are read in the same frame
+// as the events sent directly.
+template <typename T>
+void parallel_events_flush_system(Resource<ParallelEvents<T>> parallel_events, Resource<Events<T>> events)
+{
+    parallel_events->flush(*events);
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "frame_pacer.hpp"
 #include "game.hpp"
 #include <chrono>
 #include <thread>
@@ -13,6 +14,13 @@ struct RunMode
         Once,
     } type = Loop;
     tl::optional<std::chrono::duration<float>> wait;
+
+    // how the `Loop` runner waits out the rest of a frame.
+    enum Pacing
+    {
+        Precise, // sleeps coarsely and spins the last slice, see `FramePacer`
+        Sleep,   // only sleeps, cheaper on the CPU but wakes up late
+    } pacing = Precise;
 };
 
 struct SchedulerRunnerSettings
@@ -29,28 +37,31 @@ struct SchedulerRunnerSettings
         };
     }
 
-    constexpr static auto run_loop(std::chrono::duration<float> const wait) 
+    constexpr static auto run_loop(std::chrono::duration<float> const wait, RunMode::Pacing const pacing = RunMode::Precise)
         noexcept -> SchedulerRunnerSettings
     {
         return SchedulerRunnerSettings{
             .run_mode = RunMode {
                 .type = RunMode::Loop,
                 .wait = wait,
+                .pacing = pacing,
             },
         };
     }
 };
 
+// Runs the game once, or in a loop until a `GameExit` event is sent.
+// A looping runner with a `wait` paces every frame to a deadline and publishes the achieved frame times as `FrameStats`.
 struct SchedulerRunnerPlugin
 {
     void build(GameBuilder& builder)
     {
-        using clock_t = std::chrono::high_resolution_clock;
-        using dur_t = std::chrono::duration<float>;
+        using clock_t = FramePacer::clock_t;
 
         auto settings = *(builder
             .resources()
             .try_add_resource<SchedulerRunnerSettings>());
+        builder.try_add_resource<FrameStats>();
 
         auto runner = [settings = MOV(settings)](Game& game) {
             switch (settings.run_mode.type) {
@@ -59,54 +70,48 @@ struct SchedulerRunnerPlugin
                 break;
             case RunMode::Loop: {
                 auto game_exit_event_reader = ManualEventReader<GameExit>();
-
-                auto tick = [&]() -> tl::expected<tl::optional<dur_t>, GameExit> {
-                    auto check_for_app_exit = [&]() -> bool {
-                        auto events = game.resources.get_resource<Events<GameExit>>();
-                        if (!events) {
-                            return false;
-                        }
-
-                        if (game_exit_event_reader.iter(**events).size() > 0) {
-                            return true;
-                        }
-
+                auto check_for_app_exit = [&]() -> bool {
+                    auto events = game.resources.get_resource<Events<GameExit>>();
+                    if (!events) {
                         return false;
-                    };
-
-                    auto const start_time = clock_t::now();
-
-                    if (check_for_app_exit()) {
-                        return tl::make_unexpected(GameExit{});
                     }
+                    return game_exit_event_reader.iter(**events).size() > 0;
+                };
+
+                auto const wait = settings.run_mode.wait.map([](auto const w) { return std::chrono::duration_cast<clock_t::duration>(w); });
+                auto pacer = FramePacer{};
+                auto frame_start = clock_t::now();
+                auto deadline = frame_start;
 
+                for (;;) {
                     game.update();
 
+                    // checked once per frame, after the update and before waiting for the next frame.
                     if (check_for_app_exit()) {
-                        return tl::make_unexpected(GameExit{});
+                        return;
                     }
 
-                    auto const end_time = clock_t::now();
-
-                    auto const& wait = settings.run_mode.wait;
+                    bool missed = false;
                     if (wait) {
-                        auto const execution_time = std::chrono::duration_cast<dur_t>(end_time - start_time);
-                        if (execution_time < *wait) {
-                            return tl::make_optional<dur_t>(*wait - execution_time);
+                        deadline += *wait;
+                        auto const now = clock_t::now();
+                        if (now > deadline) { // frames that were missed are not caught up on
+                            missed = true;
+                            deadline = now;
+                        }
+                        else if (settings.run_mode.pacing == RunMode::Precise) {
+                            pacer.wait_until(deadline);
+                        }
+                        else {
+                            std::this_thread::sleep_until(deadline);
                         }
                     }
 
-                    return tl::optional<dur_t>();
-                };
-
-                for (;;) {
-                    auto const delay = tick();
-                    if (!delay) { // AppExit Event Received
-                        return;
-                    }
-                    if (delay->has_value()) {
-                        std::this_thread::sleep_for(**delay);
+                    auto const frame_end = clock_t::now();
+                    if (auto stats = game.resources.write_resource<FrameStats>(); stats) {
+                        (*stats)->record(frame_end - frame_start, missed);
                     }
+                    frame_start = frame_end;
                 }
             }
                 break;
@@ -117,4 +122,4 @@ struct SchedulerRunnerPlugin
 
         builder.set_runner(runner);
     }
-};
\ No newline at end of file
+};
@@ -75,8 +75,19 @@ struct MouseButtonInput
 struct MouseMotion
 {
     Vec2 delta;
+    // platform timestamps (in milliseconds) of the first and last motion merged into this event.
+    std::uint32_t first_timestamp = 0;
+    std::uint32_t last_timestamp = 0;
 };
 
+// see `CoalesceEvents<>`, deltas are summed.
+inline auto try_coalesce(MouseMotion& into, MouseMotion const& next) noexcept -> bool
+{
+    into.delta += next.delta;
+    into.last_timestamp = next.last_timestamp;
+    return true;
+}
+
 struct MouseWheel
 {
     float x = 0.f;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <core/ecs/resource.hpp>
 #include <core/window/window.hpp>
 #include <sdl/sdl.hpp>
 #include <util/common.hpp>
@@ -31,6 +32,17 @@ public:
         return RenderContext(*MOV(renderer));
     }
 
+    // a context that renders into `surface` instead of a window, `surface` has to outlive the context.
+    static auto create_software(sdl::Surface& surface) -> tl::expected<RenderContext, sdl::Error>
+    {
+        auto renderer = sdl::Renderer::create_software(surface);
+        if (!renderer) {
+            return tl::make_unexpected(renderer.error());
+        }
+
+        return RenderContext(*MOV(renderer));
+    }
+
     RenderContext(RenderContext&&) noexcept = default;
     RenderContext& operator=(RenderContext&&) noexcept = default;
 
@@ -38,4 +50,8 @@ public:
     [[nodiscard]] constexpr auto raw() noexcept { return m_renderer.raw(); }
 
     // TODO: Add more getters/setters
-};
\ No newline at end of file
+};
+
+// SDL's renderer must only be used from the thread that created it.
+template <>
+struct is_main_thread_resource<RenderContext> : std::true_type {};
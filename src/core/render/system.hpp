@@ -1,5 +1,6 @@
 #pragma once
 
+#include <core/diagnostics/trace.hpp>
 #include <core/ecs/query.hpp>
 #include <core/ecs/resource.hpp>
 #include <core/sprite/sprite.hpp>
@@ -87,5 +88,6 @@ void render_draw_system(
         }
         });
 
+    TRACE_SCOPE("SDL_RenderPresent", "render");
     SDL_RenderPresent(ctx->raw());
 }
\ No newline at end of file
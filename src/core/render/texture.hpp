@@ -1,6 +1,7 @@
 #pragma once
 
 #include <core/assets/assets.hpp>
+#include <core/diagnostics/trace.hpp>
 #include <core/ecs/resource.hpp>
 #include <core/render/render_context.hpp>
 #include <debug/debug.hpp>
@@ -159,11 +160,15 @@ public:
             return;
         }
 
+        TRACE_SCOPE("Assets<Texture>::update", "render");
         for (auto& [id, asset] : m_surfaces) {
             DEBUG_ASSERT(!asset.m_is_texture, "`Texture` is already an SDL_Texture.");
 
             auto* const sdl_surface = asset.m_surface;
-            auto* const sdl_texture = SDL_CreateTextureFromSurface(rctx.raw(), sdl_surface);
+            auto* const sdl_texture = [&] {
+                TRACE_SCOPE("SDL_CreateTextureFromSurface", "render");
+                return SDL_CreateTextureFromSurface(rctx.raw(), sdl_surface);
+            }();
 
             asset.m_texture = sdl_texture;
             asset.m_is_texture = true;
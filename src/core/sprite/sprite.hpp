@@ -8,6 +8,8 @@
 #include <core/render/texture.hpp>
 #include <core/assets/handle.hpp>
 #include <tl/optional.hpp>
+#include <span>
+#include <vector>
 
 enum class FlipState
 {
@@ -50,4 +52,35 @@ struct SpriteBundle
             world.emplace<Transparent>(e);
         }
     }
+
+    // used by `spawn_batch`, fills every component pool in one go instead of growing them entity by entity.
+    static void build_batch(World& world, std::span<entity_t const> const entities, std::span<SpriteBundle> const bundles)
+    {
+        insert_components<Sprite>(world, entities, [&](std::size_t const i) { return MOV(bundles[i].sprite); });
+        insert_components<Handle<Texture>>(world, entities, [&](std::size_t const i) { return MOV(bundles[i].texture); });
+        insert_components<Transform>(world, entities, [&](std::size_t const i) { return MOV(bundles[i].transform); });
+
+        auto visible = std::vector<entity_t>{};
+        auto transparent = std::vector<entity_t>{};
+        auto colored = std::vector<std::size_t>{};
+        for (std::size_t i = 0; i < entities.size(); ++i) {
+            if (bundles[i].is_visible) {
+                visible.push_back(entities[i]);
+            }
+            if (bundles[i].is_transparent) {
+                transparent.push_back(entities[i]);
+            }
+            if (bundles[i].color) {
+                colored.push_back(i);
+            }
+        }
+
+        world.insert<Visible>(visible.begin(), visible.end());
+        world.insert<Transparent>(transparent.begin(), transparent.end());
+
+        reserve_components<Color>(world, colored.size());
+        for (auto const i : colored) {
+            world.emplace<Color>(entities[i], *bundles[i].color);
+        }
+    }
 };
\ No newline at end of file
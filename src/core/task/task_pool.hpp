@@ -1,17 +1,506 @@
 #pragma once
 
+#include <atomic>
 #include <concepts>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <type_traits>
+#include <vector>
+#include <tl/optional.hpp>
 #include <util/common.hpp>
 
-// TODO: Make this a resource
+namespace task_detail {
+
+    // Move only, type erased `void()` callable.
+    class Job
+    {
+        struct Base
+        {
+            virtual ~Base() = default;
+            virtual void run() = 0;
+        };
+
+        template <typename F>
+        struct Impl final : Base
+        {
+            F f;
+
+            template <typename G>
+            explicit Impl(G&& g) : f(FWD(g)) {}
+
+            void run() final { f(); }
+        };
+
+        std::unique_ptr<Base> m_impl;
+
+    public:
+        Job() noexcept = default;
+
+        template <typename F>
+        requires (!std::is_same_v<std::remove_cvref_t<F>, Job> && std::is_invocable_v<std::decay_t<F>&>)
+        Job(F&& f)
+            : m_impl(std::make_unique<Impl<std::decay_t<F>>>(FWD(f)))
+        {}
+
+        Job(Job&&) noexcept = default;
+        Job& operator=(Job&&) noexcept = default;
+
+        explicit operator bool() const noexcept { return m_impl != nullptr; }
+
+        void operator()()
+        {
+            auto impl = MOV(m_impl); // the job (and its captures) are destroyed once it has run
+            impl->run();
+        }
+    };
+
+    // The owning worker pushes and pops from the back, every other thread steals from the front.
+    class WorkQueue
+    {
+        std::mutex m_mutex;
+        std::deque<Job> m_jobs;
+
+    public:
+        void push(Job job)
+        {
+            auto const lock = std::scoped_lock(m_mutex);
+            m_jobs.push_back(MOV(job));
+        }
+
+        [[nodiscard]] auto pop() -> tl::optional<Job>
+        {
+            auto const lock = std::scoped_lock(m_mutex);
+            if (m_jobs.empty()) {
+                return {};
+            }
+            auto job = MOV(m_jobs.back());
+            m_jobs.pop_back();
+            return tl::make_optional<Job>(MOV(job));
+        }
+
+        [[nodiscard]] auto steal() -> tl::optional<Job>
+        {
+            auto const lock = std::scoped_lock(m_mutex);
+            if (m_jobs.empty()) {
+                return {};
+            }
+            auto job = MOV(m_jobs.front());
+            m_jobs.pop_front();
+            return tl::make_optional<Job>(MOV(job));
+        }
+    };
+
+    // The queues shared by the workers of a pool. Every worker keeps it alive on its own, so a worker that
+    // ends up dropping the last `TaskPool` (e.g. from a job that owned a copy of it) never touches freed memory.
+    class TaskPoolInner
+    {
+        // set for every worker thread, so jobs spawned from a worker go to that worker's own queue.
+        static inline thread_local TaskPoolInner const* t_pool = nullptr;
+        static inline thread_local std::size_t t_worker_index = 0;
+
+        std::vector<std::unique_ptr<WorkQueue>> m_local_queues;
+        WorkQueue m_injector; // jobs pushed from threads outside of the pool
+        WorkQueue m_background; // jobs that are only ever run by the workers themselves
+
+        std::mutex m_sleep_mutex;
+        std::condition_variable m_sleep_cv;
+        std::condition_variable m_wait_cv; // threads waiting on a `Scope` or `Task` that ran out of jobs to help with
+        std::size_t m_waiters = 0;
+        std::atomic<std::size_t> m_queued_jobs{ 0 };
+        std::atomic<std::size_t> m_foreground_jobs{ 0 }; // the queued jobs that are not background jobs
+        bool m_stop = false;
+
+        // how many times a waiting thread finds nothing to run before it goes to sleep.
+        static constexpr std::size_t idle_spins = 16;
+
+        [[nodiscard]] auto current_worker() const noexcept -> tl::optional<std::size_t>
+        {
+            if (t_pool == this) {
+                return t_worker_index;
+            }
+            return {};
+        }
+
+        [[nodiscard]] auto taken(tl::optional<Job>&& job, bool const background = false) noexcept -> tl::optional<Job>
+        {
+            if (job) {
+                m_queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+                if (!background) {
+                    m_foreground_jobs.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+            return MOV(job);
+        }
+
+        [[nodiscard]] auto find_job(tl::optional<std::size_t> const worker) -> tl::optional<Job>
+        {
+            if (worker) {
+                if (auto job = m_local_queues[*worker]->pop(); job) {
+                    return taken(MOV(job));
+                }
+            }
+
+            if (auto job = m_injector.steal(); job) {
+                return taken(MOV(job));
+            }
+
+            // start stealing from the next worker so that thieves spread out over the queues.
+            auto const start = worker.map([](std::size_t const i) { return i + 1; }).value_or(0);
+            for (std::size_t i = 0; i < m_local_queues.size(); ++i) {
+                auto const victim = (start + i) % m_local_queues.size();
+                if (worker && victim == *worker) {
+                    continue;
+                }
+                if (auto job = m_local_queues[victim]->steal(); job) {
+                    return taken(MOV(job));
+                }
+            }
+
+            return {};
+        }
+
+        void notify_push(bool const background)
+        {
+            m_queued_jobs.fetch_add(1, std::memory_order_relaxed);
+            if (!background) {
+                m_foreground_jobs.fetch_add(1, std::memory_order_relaxed);
+            }
+            auto wake_waiters = false;
+            {
+                // synchronizes with a worker or waiter that is about to go to sleep
+                auto const lock = std::scoped_lock(m_sleep_mutex);
+                wake_waiters = !background && m_waiters != 0;
+            }
+            m_sleep_cv.notify_one();
+            if (wake_waiters) {
+                m_wait_cv.notify_all();
+            }
+        }
+
+    public:
+        explicit TaskPoolInner(std::size_t const thread_count)
+        {
+            m_local_queues.reserve(thread_count);
+            for (std::size_t i = 0; i < thread_count; ++i) {
+                m_local_queues.push_back(std::make_unique<WorkQueue>());
+            }
+        }
+
+        TaskPoolInner(TaskPoolInner const&) = delete;
+        TaskPoolInner& operator=(TaskPoolInner const&) = delete;
+
+        [[nodiscard]] auto thread_count() const noexcept -> std::size_t
+        {
+            return m_local_queues.size();
+        }
+
+        // runs jobs until `stop` has been called and every queued job has run.
+        static void worker_loop(std::shared_ptr<TaskPoolInner> const self, std::size_t const index)
+        {
+            t_pool = self.get();
+            t_worker_index = index;
+
+            for (;;) {
+                // background jobs go last, work that someone is waiting on comes first.
+                if (auto job = self->find_job(index); job) {
+                    (*job)();
+                    continue;
+                }
+                if (auto job = self->taken(self->m_background.steal(), true); job) {
+                    (*job)();
+                    continue;
+                }
+
+                auto lock = std::unique_lock(self->m_sleep_mutex);
+                self->m_sleep_cv.wait(lock, [&] { return self->m_stop || self->m_queued_jobs.load(std::memory_order_relaxed) != 0; });
+                if (self->m_stop && self->m_queued_jobs.load(std::memory_order_relaxed) == 0) {
+                    t_pool = nullptr;
+                    return;
+                }
+            }
+        }
+
+        void stop()
+        {
+            {
+                auto const lock = std::scoped_lock(m_sleep_mutex);
+                m_stop = true;
+            }
+            m_sleep_cv.notify_all();
+        }
+
+        void push(Job job)
+        {
+            if (auto const worker = current_worker(); worker) {
+                m_local_queues[*worker]->push(MOV(job));
+            }
+            else {
+                m_injector.push(MOV(job));
+            }
+            notify_push(false);
+        }
+
+        void push_background(Job job)
+        {
+            m_background.push(MOV(job));
+            notify_push(true);
+        }
+
+        // runs a single queued job on the calling thread, returns false if there was nothing to run.
+        // background jobs are never picked up here, so a thread waiting on its own work does not get stuck behind them.
+        auto try_run_one() -> bool
+        {
+            if (auto job = find_job(current_worker()); job) {
+                (*job)();
+                return true;
+            }
+            return false;
+        }
+
+        // runs queued jobs on the calling thread until `done()`, which keeps nested scopes from dead-locking.
+        // once there is nothing left to run it sleeps until a job is pushed or `notify_waiters` is called.
+        template <typename Done>
+        void run_until(Done const& done)
+        {
+            auto misses = std::size_t{ 0 };
+            while (!done()) {
+                if (try_run_one()) {
+                    misses = 0;
+                }
+                else if (++misses < idle_spins) {
+                    std::this_thread::yield();
+                }
+                else {
+                    auto lock = std::unique_lock(m_sleep_mutex);
+                    ++m_waiters;
+                    m_wait_cv.wait(lock, [&] { return done() || m_foreground_jobs.load(std::memory_order_relaxed) != 0; });
+                    --m_waiters;
+                    misses = 0;
+                }
+            }
+        }
+
+        // wakes the threads sleeping in `run_until`, to be called once what they wait on is done.
+        void notify_waiters()
+        {
+            {
+                auto const lock = std::scoped_lock(m_sleep_mutex);
+                if (m_waiters == 0) {
+                    return;
+                }
+            }
+            m_wait_cv.notify_all();
+        }
+    };
+
+    // Owns the worker threads, stops them once the last `TaskPool` referring to them is gone.
+    class TaskPoolWorkers
+    {
+        std::shared_ptr<TaskPoolInner> m_inner;
+        std::vector<std::thread> m_threads;
+
+    public:
+        explicit TaskPoolWorkers(std::size_t const thread_count)
+            : m_inner(std::make_shared<TaskPoolInner>(thread_count))
+        {
+            m_threads.reserve(thread_count);
+            for (std::size_t i = 0; i < thread_count; ++i) {
+                m_threads.emplace_back(&TaskPoolInner::worker_loop, m_inner, i);
+            }
+        }
+
+        TaskPoolWorkers(TaskPoolWorkers const&) = delete;
+        TaskPoolWorkers& operator=(TaskPoolWorkers const&) = delete;
+
+        ~TaskPoolWorkers()
+        {
+            m_inner->stop();
+            for (auto& thread : m_threads) {
+                // the last reference to the pool may be dropped by a job running on one of its own workers,
+                // that worker finishes the remaining jobs on its own copy of the queues.
+                if (thread.get_id() == std::this_thread::get_id()) {
+                    thread.detach();
+                }
+                else {
+                    thread.join();
+                }
+            }
+        }
+
+        [[nodiscard]] auto inner() const noexcept -> std::shared_ptr<TaskPoolInner> const&
+        {
+            return m_inner;
+        }
+    };
+
+    template <typename T>
+    struct TaskState
+    {
+        std::atomic<bool> ready{ false };
+        tl::optional<T> value;
+    };
+
+    template <>
+    struct TaskState<void>
+    {
+        std::atomic<bool> ready{ false };
+    };
+
+} // namespace task_detail
+
+// Handle to the result of a job spawned on a `TaskPool`.
+// Waiting on a task runs other queued jobs (but not those queued with `execute`) as long as the pool is alive, and only sleeps
+// once there is nothing left for it to run.
+template <typename T>
+class Task
+{
+    std::shared_ptr<task_detail::TaskState<T>> m_state;
+    std::weak_ptr<task_detail::TaskPoolInner> m_pool;
+
+    friend class TaskPool;
+
+    Task(std::shared_ptr<task_detail::TaskState<T>> state, std::weak_ptr<task_detail::TaskPoolInner> pool) noexcept
+        : m_state(MOV(state))
+        , m_pool(MOV(pool))
+    {}
+
+public:
+    Task(Task&&) noexcept = default;
+    Task& operator=(Task&&) noexcept = default;
+    Task(Task const&) = delete;
+    Task& operator=(Task const&) = delete;
+
+    [[nodiscard]] auto is_ready() const noexcept -> bool
+    {
+        return m_state->ready.load(std::memory_order_acquire);
+    }
+
+    void wait() const
+    {
+        if (auto const pool = m_pool.lock(); pool) {
+            pool->run_until([this] { return is_ready(); });
+        }
+        else {
+            m_state->ready.wait(false, std::memory_order_acquire);
+        }
+    }
+
+    // Waits for the task to finish and returns its result. Can only be called once.
+    auto get() -> T
+    {
+        wait();
+        if constexpr (!std::is_void_v<T>) {
+            return MOV(*m_state->value);
+        }
+    }
+};
+
 class TaskPool
 {
+    std::shared_ptr<task_detail::TaskPoolWorkers> m_workers;
+
 public:
+    // Tasks spawned from a `Scope` are guaranteed to have finished once `TaskPool::scope` returns,
+    // so they are allowed to borrow from the enclosing stack frame.
+    class Scope
+    {
+        task_detail::TaskPoolInner* m_inner;
+        std::atomic<std::size_t> m_pending{ 0 };
+
+        friend class TaskPool;
+
+        explicit Scope(task_detail::TaskPoolInner& inner) noexcept
+            : m_inner(std::addressof(inner))
+        {}
+
+        void join()
+        {
+            // background jobs are left to the workers, so a scope never waits on something like an asset decode.
+            m_inner->run_until([this] { return m_pending.load(std::memory_order_acquire) == 0; });
+        }
+
+    public:
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        template <std::invocable F>
+        void spawn(F&& f)
+        {
+            m_pending.fetch_add(1, std::memory_order_relaxed);
+            m_inner->push([this, inner = m_inner, f = FWD(f)]() mutable {
+                {
+                    auto task = MOV(f); // destroyed before signaling completion
+                    task();
+                }
+                // the scope may be gone as soon as the last task has signaled, only `inner` is used after that.
+                if (m_pending.fetch_sub(1, std::memory_order_release) == 1) {
+                    inner->notify_waiters();
+                }
+            });
+        }
+    };
+
+    explicit TaskPool(std::size_t const thread_count = default_thread_count())
+        : m_workers(std::make_shared<task_detail::TaskPoolWorkers>(thread_count))
+    {}
+
+    TaskPool(TaskPool&&) noexcept = default;
+    TaskPool& operator=(TaskPool&&) noexcept = default;
+    TaskPool(TaskPool const&) noexcept = default;
+    TaskPool& operator=(TaskPool const&) noexcept = default;
+
+    [[nodiscard]] static auto default_thread_count() noexcept -> std::size_t
+    {
+        auto const count = std::thread::hardware_concurrency();
+        return count > 1 ? count - 1 : 1;
+    }
+
+    [[nodiscard]] auto thread_count() const noexcept -> std::size_t
+    {
+        return m_workers->inner()->thread_count();
+    }
+
+    // Queues `f` on the pool and returns a handle to its result.
+    template <std::invocable F>
+    [[nodiscard]] auto spawn(F&& f) const -> Task<std::invoke_result_t<std::decay_t<F>&>>
+    {
+        using result_t = std::invoke_result_t<std::decay_t<F>&>;
+        auto state = std::make_shared<task_detail::TaskState<result_t>>();
+
+        m_workers->inner()->push([state, inner = m_workers->inner().get(), f = FWD(f)]() mutable {
+            if constexpr (std::is_void_v<result_t>) {
+                f();
+            }
+            else {
+                state->value.emplace(f());
+            }
+            state->ready.store(true, std::memory_order_release);
+            state->ready.notify_all();
+            inner->notify_waiters();
+        });
+
+        return Task<result_t>(MOV(state), m_workers->inner());
+    }
+
+    // Queues `f` on the pool without a way to wait on it.
+    // It only ever runs on a worker, threads waiting on a `Scope` or `Task` never pick it up.
     template <std::invocable F>
     void execute(F&& f) const
     {
-        auto t = std::thread(FWD(f));
-        t.detach();
+        m_workers->inner()->push_background(FWD(f));
+    }
+
+    // Invokes `f(Scope&)` on the calling thread and blocks until every task spawned on the scope has completed.
+    // The calling thread participates in running queued tasks while it waits.
+    template <typename F>
+    requires (std::is_invocable_v<F, Scope&>)
+    void scope(F&& f) const
+    {
+        auto s = Scope(*m_workers->inner());
+        FWD(f)(s);
+        s.join();
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <core/ecs/scheduler.hpp>
+#include <debug/debug.hpp>
+#include "time.hpp"
+
+// Runs its systems once for every `FixedTime::step()` of `Time::delta()` that has accumulated,
+// which can be zero or several times per frame.
+class FixedTimestepStage : public Stage
+{
+public:
+    explicit FixedTimestepStage(Stage&& stage) noexcept
+        : Stage(MOV(stage))
+    {}
+
+    template <typename StageTag>
+    static auto create() -> FixedTimestepStage
+    {
+        return FixedTimestepStage(Stage::create<StageTag>());
+    }
+
+    void run(Resources& resources, World& world) override
+    {
+        auto const steps = [&resources]() -> std::size_t {
+            auto const time = resources.read_resource<Time>();
+            auto fixed_time = resources.write_resource<FixedTime>();
+            DEBUG_ASSERT(time && fixed_time, "A fixed timestep stage needs both the `Time` and `FixedTime` resources.");
+            return time && fixed_time ? (*fixed_time)->accumulate((*time)->delta()) : 0;
+        }();
+
+        for (std::size_t i = 0; i < steps; ++i) {
+            (*resources.write_resource<FixedTime>())->expend();
+            Stage::run(resources, world);
+        }
+    }
+};
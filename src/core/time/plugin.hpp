@@ -0,0 +1,19 @@
+#pragma once
+
+#include <core/game/game.hpp>
+#include "fixed_timestep.hpp"
+#include "time.hpp"
+
+// Adds the `Time` and `FixedTime` resources, and the `CoreStages::FixedUpdate` stage.
+// Set a `FixedTime` resource before adding the plugin to change the step, e.g. `FixedTime::from_hz(60.0)`.
+struct TimePlugin
+{
+    void build(GameBuilder& builder) const
+    {
+        builder
+            .try_add_resource<Time>()
+            .try_add_resource<FixedTime>()
+            .add_stage_after<CoreStages::FixedUpdate, CoreStages::PreUpdate, FixedTimestepStage>()
+            .add_system_to_stage<CoreStages::PreEvents>(time_system);
+    }
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <tl/optional.hpp>
+#include <core/ecs/resource.hpp>
+#include <debug/debug.hpp>
+
+// Wall clock time of the current frame, updated by `time_system` at the start of every frame.
+class Time
+{
+public:
+    using clock_t = std::chrono::steady_clock;
+    using duration_t = clock_t::duration;
+
+private:
+    clock_t::time_point m_startup = clock_t::now();
+    tl::optional<clock_t::time_point> m_last_update;
+    duration_t m_delta = duration_t::zero();
+    duration_t m_elapsed = duration_t::zero();
+    std::uint64_t m_frame_count = 0;
+
+public:
+    void update()
+    {
+        update_with_instant(clock_t::now());
+    }
+
+    // advances the time to `now`, the first update has a delta of zero.
+    void update_with_instant(clock_t::time_point const now)
+    {
+        m_delta = m_last_update ? now - *m_last_update : duration_t::zero();
+        m_last_update = now;
+        m_elapsed = now - m_startup;
+        ++m_frame_count;
+    }
+
+    [[nodiscard]] auto delta() const noexcept -> duration_t { return m_delta; }
+    [[nodiscard]] auto delta_seconds() const noexcept -> float { return std::chrono::duration<float>(m_delta).count(); }
+    [[nodiscard]] auto elapsed() const noexcept -> duration_t { return m_elapsed; }
+    [[nodiscard]] auto elapsed_seconds() const noexcept -> double { return std::chrono::duration<double>(m_elapsed).count(); }
+    [[nodiscard]] auto startup() const noexcept -> clock_t::time_point { return m_startup; }
+    [[nodiscard]] auto frame_count() const noexcept -> std::uint64_t { return m_frame_count; }
+};
+
+// Simulation time of the `FixedUpdate` stage, which runs once for every `step()` of frame time that has passed.
+// `alpha()` is how far the frame is between the last and the next step, renderers use it to interpolate.
+class FixedTime
+{
+public:
+    using duration_t = Time::duration_t;
+
+    static constexpr auto default_step = duration_t(std::chrono::nanoseconds(1'000'000'000 / 60));
+    static constexpr std::size_t default_max_steps = 5;
+
+private:
+    duration_t m_step;
+    std::size_t m_max_steps;
+    duration_t m_accumulator = duration_t::zero();
+    duration_t m_elapsed = duration_t::zero();
+    std::uint64_t m_step_count = 0;
+    std::uint64_t m_dropped_steps = 0;
+
+public:
+    explicit FixedTime(duration_t const step = default_step, std::size_t const max_steps = default_max_steps) noexcept
+        : m_step(step)
+        , m_max_steps(max_steps)
+    {
+        DEBUG_ASSERT(step > duration_t::zero(), "The fixed timestep has to be greater than zero.");
+    }
+
+    [[nodiscard]] static auto from_hz(double const hz, std::size_t const max_steps = default_max_steps) noexcept -> FixedTime
+    {
+        return FixedTime(std::chrono::duration_cast<duration_t>(std::chrono::duration<double>(1.0 / hz)), max_steps);
+    }
+
+    // Adds a frame's worth of time and returns how many steps have to run to catch up, at most `max_steps()`.
+    // Whole steps past that are dropped, so that a slow frame does not make the following frames even slower.
+    auto accumulate(duration_t const delta) noexcept -> std::size_t
+    {
+        m_accumulator += delta;
+
+        auto steps = static_cast<std::size_t>(m_accumulator / m_step);
+        if (steps > m_max_steps) {
+            m_dropped_steps += steps - m_max_steps;
+            steps = m_max_steps;
+            m_accumulator %= m_step;
+        }
+        else {
+            m_accumulator -= m_step * static_cast<duration_t::rep>(steps);
+        }
+        return steps;
+    }
+
+    // called before every run of the `FixedUpdate` stage.
+    void expend() noexcept
+    {
+        m_elapsed += m_step;
+        ++m_step_count;
+    }
+
+    void set_step(duration_t const step) noexcept
+    {
+        DEBUG_ASSERT(step > duration_t::zero(), "The fixed timestep has to be greater than zero.");
+        m_step = step;
+    }
+
+    void set_max_steps(std::size_t const max_steps) noexcept { m_max_steps = max_steps; }
+
+    [[nodiscard]] auto step() const noexcept -> duration_t { return m_step; }
+    [[nodiscard]] auto step_seconds() const noexcept -> float { return std::chrono::duration<float>(m_step).count(); }
+    [[nodiscard]] auto max_steps() const noexcept -> std::size_t { return m_max_steps; }
+    [[nodiscard]] auto accumulated() const noexcept -> duration_t { return m_accumulator; }
+    [[nodiscard]] auto elapsed() const noexcept -> duration_t { return m_elapsed; }
+    [[nodiscard]] auto step_count() const noexcept -> std::uint64_t { return m_step_count; }
+    // steps that were skipped because a frame took longer than `max_steps()` steps.
+    [[nodiscard]] auto dropped_steps() const noexcept -> std::uint64_t { return m_dropped_steps; }
+
+    // in [0, 1), the fraction of a step that has accumulated since the last step.
+    [[nodiscard]] auto alpha() const noexcept -> float
+    {
+        return std::chrono::duration<float>(m_accumulator) / std::chrono::duration<float>(m_step);
+    }
+};
+
+inline void time_system(Resource<Time> time)
+{
+    time->update();
+}
@@ -137,8 +137,23 @@ struct CursorMoved
 {
     WindowId id;
     Vec2 position;
+    // platform timestamps (in milliseconds) of the first and last movement merged into this event.
+    std::uint32_t first_timestamp = 0;
+    std::uint32_t last_timestamp = 0;
 };
 
+// see `CoalesceEvents<>`, only the last position is kept. movements in different windows are not merged.
+inline auto try_coalesce(CursorMoved& into, CursorMoved const& next) noexcept -> bool
+{
+    if (into.id != next.id) {
+        return false;
+    }
+
+    into.position = next.position;
+    into.last_timestamp = next.last_timestamp;
+    return true;
+}
+
 struct CursorEntered
 {
     WindowId id;
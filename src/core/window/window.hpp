@@ -1,5 +1,6 @@
 #pragma once
 
+#include <core/ecs/resource.hpp>
 #include <core/math/vec.hpp>
 #include <core/window/event.hpp>
 #include <sdl/sdl.hpp>
@@ -110,4 +111,7 @@ public:
     {
         return std::string_view{ SDL_GetWindowTitle(const_cast<SDL_Window*>(m_window.raw())) };
     }
-};
\ No newline at end of file
+};
+
+template <>
+struct is_main_thread_resource<Window> : std::true_type {};
@@ -95,6 +95,8 @@ namespace sdl {
         ~Window() noexcept { if (m_window) SDL_DestroyWindow(m_window); }
     };
 
+    class Surface;
+
     class Renderer {
         SDL_Renderer* m_renderer = nullptr;
 
@@ -127,6 +129,9 @@ namespace sdl {
             return Renderer(renderer);
         }
 
+        // renders into `surface` on the CPU, e.g. for benchmarks or when there is no window.
+        static auto create_software(Surface& surface) -> tl::expected<Renderer, Error>;
+
         constexpr auto raw() noexcept -> SDL_Renderer* { return m_renderer; }
         constexpr auto raw() const noexcept -> SDL_Renderer const* { return m_renderer; }
 
@@ -163,6 +168,15 @@ namespace sdl {
         ~Surface() noexcept { if (m_surface) SDL_FreeSurface(m_surface); }
     };
 
+    inline auto Renderer::create_software(Surface& surface) -> tl::expected<Renderer, Error>
+    {
+        auto const renderer = SDL_CreateSoftwareRenderer(surface.raw());
+        if (renderer == nullptr) {
+            return tl::make_unexpected(Error::current());
+        }
+        return Renderer(renderer);
+    }
+
     class Texture {
         SDL_Texture* m_texture = nullptr;
 
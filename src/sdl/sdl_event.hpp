@@ -2,6 +2,7 @@
 
 #include <sdl/sdl.hpp>
 #include <sdl/sdl_keyboard.hpp>
+#include <core/game/event_coalescing.hpp>
 #include <core/game/events.hpp>
 #include <core/game/game.hpp>
 #include <core/input/input.hpp>
@@ -11,6 +12,53 @@
 
 namespace {
 
+    template <typename T>
+    auto sdl_event_sink(Resources& resources) -> Events<T>*
+    {
+        return resources.get_resource<Events<T>>().map([](auto e) { return std::addressof(*e); }).value_or(nullptr);
+    }
+
+    template <typename T>
+    auto sdl_expect_sink(Events<T>* const events) -> Events<T>&
+    {
+        DEBUG_ASSERT(events != nullptr, "Events<{}> does not exist.", type_name<T>());
+        return *events;
+    }
+
+    // every `Events<>` the platform events are sent to, looked up once per poll rather than once per event.
+    struct SDLEventSinks
+    {
+        Events<GameExit>* exit;
+        CoalescingEventWriter<MouseMotion> mouse_motion;
+        CoalescingEventWriter<CursorMoved> cursor_moved;
+        Events<MouseButtonInput>* mouse_button;
+        Events<MouseWheel>* mouse_wheel;
+        Events<KeyboardInput>* keyboard;
+        Events<WindowResized>* window_resized;
+        Events<WindowCloseRequest>* window_close_request;
+        Events<CursorEntered>* cursor_entered;
+        Events<CursorLeft>* cursor_left;
+        Events<WindowFocused>* window_focused;
+        Events<WindowMoved>* window_moved;
+        Events<FileDragAndDrop>* file_drag_and_drop;
+
+        explicit SDLEventSinks(Resources& resources)
+            : exit(sdl_event_sink<GameExit>(resources))
+            , mouse_motion(CoalescingEventWriter<MouseMotion>::create(resources))
+            , cursor_moved(CoalescingEventWriter<CursorMoved>::create(resources))
+            , mouse_button(sdl_event_sink<MouseButtonInput>(resources))
+            , mouse_wheel(sdl_event_sink<MouseWheel>(resources))
+            , keyboard(sdl_event_sink<KeyboardInput>(resources))
+            , window_resized(sdl_event_sink<WindowResized>(resources))
+            , window_close_request(sdl_event_sink<WindowCloseRequest>(resources))
+            , cursor_entered(sdl_event_sink<CursorEntered>(resources))
+            , cursor_left(sdl_event_sink<CursorLeft>(resources))
+            , window_focused(sdl_event_sink<WindowFocused>(resources))
+            , window_moved(sdl_event_sink<WindowMoved>(resources))
+            , file_drag_and_drop(sdl_event_sink<FileDragAndDrop>(resources))
+        {}
+    };
+
     void sdl_handle_quit_event(
         Events<GameExit>& exit_events,
         SDL_QuitEvent const&)
@@ -19,17 +67,21 @@ namespace {
     }
 
     void sdl_handle_mouse_motion_event(
-        Events<MouseMotion>& motion_events,
-        Events<CursorMoved>& cursor_events,
+        CoalescingEventWriter<MouseMotion>& motion_events,
+        CoalescingEventWriter<CursorMoved>& cursor_events,
         SDL_MouseMotionEvent const& e)
     {
         motion_events.send(MouseMotion{
             .delta = Vec2(static_cast<float>(e.xrel), static_cast<float>(e.yrel)),
+            .first_timestamp = e.timestamp,
+            .last_timestamp = e.timestamp,
             });
 
         cursor_events.send(CursorMoved{
             .id = WindowId{.id = e.windowID },
             .position = Vec2(static_cast<float>(e.x), static_cast<float>(e.y)),
+            .first_timestamp = e.timestamp,
+            .last_timestamp = e.timestamp,
             });
     }
 
@@ -88,15 +140,13 @@ namespace {
 
     void sdl_handle_window_event(
         SDL_WindowEvent const& e,
-        Resources& resources)
+        SDLEventSinks& sinks)
     {
         auto const id = WindowId{ .id = e.windowID };
 
         switch (e.event) {
         case SDL_WINDOWEVENT_RESIZED: {
-            auto events = resources.get_resource<Events<WindowResized>>();
-            DEBUG_ASSERT(events.has_value(), "Events<WindowResized> does not exist.");
-            (**events).send(WindowResized{
+            sdl_expect_sink(sinks.window_resized).send(WindowResized{
                 .id = id,
                 .width = e.data1,
                 .height = e.data2,
@@ -104,39 +154,27 @@ namespace {
         } break;
 
         case SDL_WINDOWEVENT_CLOSE: {
-            auto events = resources.get_resource<Events<WindowCloseRequest>>();
-            DEBUG_ASSERT(events.has_value(), "Events<WindowCloseRequest> does not exist.");
-            (**events).send(WindowCloseRequest{ .id = id });
+            sdl_expect_sink(sinks.window_close_request).send(WindowCloseRequest{ .id = id });
         } break;
 
         case SDL_WINDOWEVENT_ENTER: {
-            auto events = resources.get_resource<Events<CursorEntered>>();
-            DEBUG_ASSERT(events.has_value(), "Events<CursorEntered> does not exist.");
-            (**events).send(CursorEntered{ .id = id });
+            sdl_expect_sink(sinks.cursor_entered).send(CursorEntered{ .id = id });
         } break;
 
         case SDL_WINDOWEVENT_LEAVE: {
-            auto events = resources.get_resource<Events<CursorLeft>>();
-            DEBUG_ASSERT(events.has_value(), "Events<CursorLeft> does not exist.");
-            (**events).send(CursorLeft{ .id = id });
+            sdl_expect_sink(sinks.cursor_left).send(CursorLeft{ .id = id });
         } break;
 
         case SDL_WINDOWEVENT_FOCUS_GAINED: {
-            auto events = resources.get_resource<Events<WindowFocused>>();
-            DEBUG_ASSERT(events.has_value(), "Events<WindowFocused> does not exist.");
-            (**events).send(WindowFocused{ .id = id, .focused = true });
+            sdl_expect_sink(sinks.window_focused).send(WindowFocused{ .id = id, .focused = true });
         } break;
 
         case SDL_WINDOWEVENT_FOCUS_LOST: {
-            auto events = resources.get_resource<Events<WindowFocused>>();
-            DEBUG_ASSERT(events.has_value(), "Events<WindowFocused> does not exist.");
-            (**events).send(WindowFocused{ .id = id, .focused = false });
+            sdl_expect_sink(sinks.window_focused).send(WindowFocused{ .id = id, .focused = false });
         } break;
 
         case SDL_WINDOWEVENT_MOVED: {
-            auto events = resources.get_resource<Events<WindowMoved>>();
-            DEBUG_ASSERT(events.has_value(), "Events<WindowMoved> does not exist.");
-            (**events).send(WindowMoved{
+            sdl_expect_sink(sinks.window_moved).send(WindowMoved{
                 .id = id,
                 .position = Vec2i{e.data1, e.data2}
                 });
@@ -162,60 +200,47 @@ namespace {
 
 } // namespace
 
+// `MouseMotion` and `CursorMoved` are merged per poll for the types that opted in with `CoalesceEvents<>`.
 void sdl_handle_event(Resources& resources)
 {
+    auto sinks = SDLEventSinks(resources);
+
     SDL_Event e{};
     while (SDL_PollEvent(&e)) {
         switch (e.type) {
-            case SDL_QUIT: {
-                auto events = resources.get_resource<Events<GameExit>>();
-                DEBUG_ASSERT(events.has_value(), "Events<GameExit> does not exist.");
-                sdl_handle_quit_event(**events, e.quit);
-            } break;
+            case SDL_QUIT:
+                sdl_handle_quit_event(sdl_expect_sink(sinks.exit), e.quit);
+                break;
             
-            case SDL_MOUSEMOTION: {
-                auto mouse_motion_events = resources.get_resource<Events<MouseMotion>>();
-                DEBUG_ASSERT(mouse_motion_events.has_value(), "Events<MouseMotion> does not exist.");
-
-                auto cursor_moved_events = resources.get_resource<Events<CursorMoved>>();
-                DEBUG_ASSERT(cursor_moved_events.has_value(), "Events<CursorMoved> does not exist.");
-
-                sdl_handle_mouse_motion_event(**mouse_motion_events, **cursor_moved_events, e.motion);
-            } break;
+            case SDL_MOUSEMOTION:
+                sdl_handle_mouse_motion_event(sinks.mouse_motion, sinks.cursor_moved, e.motion);
+                break;
             
             case SDL_MOUSEBUTTONDOWN: 
                 [[fallthrough]];
-            case SDL_MOUSEBUTTONUP: {
-                auto events = resources.get_resource<Events<MouseButtonInput>>();
-                DEBUG_ASSERT(events.has_value(), "Events<MouseButtonInput> does not exist.");
-                sdl_handle_mouse_button_event(**events, e.button);
-            } break;
+            case SDL_MOUSEBUTTONUP:
+                sdl_handle_mouse_button_event(sdl_expect_sink(sinks.mouse_button), e.button);
+                break;
            
-            case SDL_MOUSEWHEEL: {
-                auto events = resources.get_resource<Events<MouseWheel>>();
-                DEBUG_ASSERT(events.has_value(), "Events<MouseWheel> does not exist.");
-                sdl_handle_mouse_wheel_event(**events, e.wheel);
-            } break;
+            case SDL_MOUSEWHEEL:
+                sdl_handle_mouse_wheel_event(sdl_expect_sink(sinks.mouse_wheel), e.wheel);
+                break;
             
             case SDL_KEYDOWN: 
                 [[fallthrough]];
-            case SDL_KEYUP: {
-                auto events = resources.get_resource<Events<KeyboardInput>>();
-                DEBUG_ASSERT(events.has_value(), "Events<KeyboardInput> does not exist.");
-                sdl_handle_keyboard_event(**events, e.key);
-            } break;
+            case SDL_KEYUP:
+                sdl_handle_keyboard_event(sdl_expect_sink(sinks.keyboard), e.key);
+                break;
             
             case SDL_WINDOWEVENT:
-                sdl_handle_window_event(e.window, resources);
+                sdl_handle_window_event(e.window, sinks);
                 break;
 
             case SDL_DROPTEXT:
                 [[fallthrough]];
-            case SDL_DROPFILE: {
-                auto events = resources.get_resource<Events<FileDragAndDrop>>();
-                DEBUG_ASSERT(events.has_value(), "Events<FileDragAndDrop> does not exist.");
-                sdl_handle_file_drag_and_drop(e.drop, **events);
-            } break;
+            case SDL_DROPFILE:
+                sdl_handle_file_drag_and_drop(e.drop, sdl_expect_sink(sinks.file_drag_and_drop));
+                break;
             
             default:
                 break;
@@ -1,24 +1,114 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <cstring>
 #include <core/assets/loader.hpp>
 #include <core/render/texture.hpp>
 
 struct SDL_IMG_Loader final : public AssetLoader
 {
     static constexpr auto exts = std::array<std::string_view, 1>{ "png" };
-    
+
+    // cached surfaces are stored in the format textures are created from, so a cache hit is a single copy.
+    static constexpr std::uint32_t cached_format = SDL_PIXELFORMAT_RGBA32;
+
+    struct CachedSurface
+    {
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t pitch;
+        std::uint32_t format;
+    };
+
     auto extensions() const noexcept -> std::span<std::string_view const> final
     {
         return std::span<std::string_view const>{ exts.data(), exts.size() };
     }
-    
-    auto load(std::filesystem::path const&, std::span<std::byte> const bytes) const -> tl::optional<LoadedAsset>
+
+    auto load(std::filesystem::path const&, std::span<std::byte const> const bytes) const -> tl::optional<LoadedAsset> final
     {
-        auto* const surface = IMG_Load_RW(SDL_RWFromMem(bytes.data(), static_cast<int>(bytes.size())), 1);
+        auto* const surface = IMG_Load_RW(SDL_RWFromConstMem(bytes.data(), static_cast<int>(bytes.size())), 1);
         if (surface == nullptr) {
             return {};
         }
         return LoadedAsset::create<Texture>(surface);
     }
-};
\ No newline at end of file
+
+    auto cache_version() const noexcept -> tl::optional<std::uint32_t> final
+    {
+        return 1;
+    }
+
+    auto write_cache(LoadedAsset const& asset, std::vector<std::byte>& out) const -> bool final
+    {
+        auto const* const texture = asset.get<Texture>();
+        if (texture == nullptr || texture->m_is_texture || texture->m_surface == nullptr) {
+            return false;
+        }
+
+        auto* const source = texture->m_surface;
+        auto* const surface = source->format->format == cached_format ? source : SDL_ConvertSurfaceFormat(source, cached_format, 0);
+        if (surface == nullptr) {
+            return false;
+        }
+
+        auto const header = CachedSurface{
+            .width = static_cast<std::uint32_t>(surface->w),
+            .height = static_cast<std::uint32_t>(surface->h),
+            .pitch = static_cast<std::uint32_t>(surface->w) * 4,
+            .format = cached_format,
+        };
+
+        auto const offset = out.size();
+        out.resize(offset + sizeof(header) + std::size_t{ header.pitch } * header.height);
+        std::memcpy(out.data() + offset, &header, sizeof(header));
+
+        bool const must_lock = SDL_MUSTLOCK(surface);
+        if (!must_lock || SDL_LockSurface(surface) == 0) {
+            auto* dst = out.data() + offset + sizeof(header);
+            auto const* src = static_cast<std::byte const*>(surface->pixels);
+            for (auto row = 0u; row < header.height; ++row, dst += header.pitch, src += surface->pitch) {
+                std::memcpy(dst, src, header.pitch);
+            }
+            if (must_lock) {
+                SDL_UnlockSurface(surface);
+            }
+        }
+        else {
+            out.resize(offset);
+        }
+
+        if (surface != source) {
+            SDL_FreeSurface(surface);
+        }
+        return out.size() != offset;
+    }
+
+    auto load_cached(std::filesystem::path const&, std::span<std::byte const> const bytes) const -> tl::optional<LoadedAsset> final
+    {
+        auto header = CachedSurface{};
+        if (bytes.size() < sizeof(header)) {
+            return {};
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+
+        auto const pixels = bytes.subspan(sizeof(header));
+        if (header.format != cached_format || header.pitch != header.width * 4
+            || pixels.size() != std::size_t{ header.pitch } * header.height) {
+            return {};
+        }
+
+        auto* const surface = SDL_CreateRGBSurfaceWithFormat(0, static_cast<int>(header.width), static_cast<int>(header.height), 32, header.format);
+        if (surface == nullptr) {
+            return {};
+        }
+
+        auto* dst = static_cast<std::byte*>(surface->pixels);
+        auto const* src = pixels.data();
+        for (auto row = 0u; row < header.height; ++row, dst += surface->pitch, src += header.pitch) {
+            std::memcpy(dst, src, header.pitch);
+        }
+        return LoadedAsset::create<Texture>(surface);
+    }
+};
@@ -0,0 +1,154 @@
+#include <ut.hpp>
+#include <core/assets/asset_cache.hpp>
+#include <core/assets/asset_server.hpp>
+
+#include <atomic>
+#include <cstring>
+#include <filesystem>
+#include <string_view>
+
+using namespace boost::ut;
+namespace fs = std::filesystem;
+
+namespace asset_cache_test_ns {
+
+    auto as_bytes(std::string_view const str) -> std::span<std::byte const>
+    {
+        return std::as_bytes(std::span(str.data(), str.size()));
+    }
+
+    // every path holds the same text, and the decoded asset is its length.
+    struct TextAssetIo final : public AssetIo
+    {
+        std::string text;
+
+        explicit TextAssetIo(std::string t) : text(MOV(t)) {}
+
+        auto load_path(std::filesystem::path const&) const -> std::function<Result()> final
+        {
+            return [bytes = as_bytes(text)]() -> Result {
+                return AssetBytes::from_vector(std::vector<std::byte>(bytes.begin(), bytes.end()));
+            };
+        }
+
+        auto root_path() const noexcept -> std::filesystem::path final { return std::filesystem::path("."); }
+    };
+
+    struct TextLength
+    {
+        std::size_t value;
+    };
+
+    struct CachingTextLoader final : AssetLoader
+    {
+        static constexpr auto exts = std::array<std::string_view, 1>{ "txt" };
+        inline static std::atomic<int> times_decoded{ 0 };
+        inline static std::atomic<int> times_cached{ 0 };
+
+        auto extensions() const noexcept -> std::span<std::string_view const> final
+        {
+            return std::span{ exts.data(), 1 };
+        }
+
+        auto load(std::filesystem::path const&, std::span<std::byte const> bytes) const -> tl::optional<LoadedAsset> final
+        {
+            ++times_decoded;
+            return LoadedAsset::create<TextLength>(bytes.size());
+        }
+
+        auto cache_version() const noexcept -> tl::optional<std::uint32_t> final { return 1; }
+
+        auto write_cache(LoadedAsset const& asset, std::vector<std::byte>& out) const -> bool final
+        {
+            auto const value = asset.get<TextLength>()->value;
+            auto const bytes = std::as_bytes(std::span(&value, 1));
+            out.insert(out.end(), bytes.begin(), bytes.end());
+            return true;
+        }
+
+        auto load_cached(std::filesystem::path const&, std::span<std::byte const> bytes) const -> tl::optional<LoadedAsset> final
+        {
+            if (bytes.size() != sizeof(std::size_t)) {
+                return tl::nullopt;
+            }
+            ++times_cached;
+            auto value = std::size_t{};
+            std::memcpy(&value, bytes.data(), sizeof(value));
+            return LoadedAsset::create<TextLength>(value);
+        }
+    };
+
+    auto load_length(AssetCache const& cache, std::string text) -> tl::optional<std::size_t>
+    {
+        auto server = AssetServer(std::make_unique<TextAssetIo>(MOV(text)), TaskPool{});
+        auto assets = server.register_asset_type<TextLength>();
+        server.add_asset_loader<CachingTextLoader>();
+        server.set_asset_cache(cache);
+
+        if (!server.load_sync("file.txt")) {
+            return tl::nullopt;
+        }
+        server.update_assets(assets);
+        if (assets.size() != 1) {
+            return tl::nullopt;
+        }
+        return assets.begin()->second.value;
+    }
+
+} // namespace asset_cache_test_ns
+
+void asset_cache_test()
+{
+    using namespace asset_cache_test_ns;
+
+    auto const folder = fs::temp_directory_path() / "asset_cache_test";
+    fs::remove_all(folder);
+
+    "[asset_cache] content_hash"_test = [] {
+        // XXH64 reference values
+        expect(asset_cache::content_hash({}) == 0xEF46DB3751D8E999u);
+        expect(asset_cache::content_hash(as_bytes("abc")) == 0x44BC2CF5AD770999u);
+        expect(asset_cache::content_hash(as_bytes("Nobody inspects the spammish repetition")) == 0xFBCEA83C8A378BF1u);
+    };
+
+    "[AssetCache]"_test = [&] {
+        auto cache = AssetCache::create(folder);
+        expect((cache.has_value()) >> fatal);
+        expect(fs::is_directory(folder));
+
+        auto const key = asset_cache::Key::from_source(as_bytes("source"), "txt", 1);
+        expect(!cache->find(key).has_value());
+
+        expect(cache->store(key, as_bytes("decoded")));
+        auto const found = cache->find(key);
+        expect((found.has_value()) >> fatal);
+        expect(std::ranges::equal(found->span(), as_bytes("decoded")));
+
+        should("miss for a changed source or loader version") = [&] {
+            expect(!cache->find(asset_cache::Key::from_source(as_bytes("sourcf"), "txt", 1)).has_value());
+            expect(!cache->find(asset_cache::Key::from_source(as_bytes("source"), "txt", 2)).has_value());
+            expect(!cache->find(asset_cache::Key::from_source(as_bytes("source"), "png", 1)).has_value());
+        };
+    };
+
+    "[AssetServer] asset cache"_test = [&] {
+        auto const cache = AssetCache::create(folder);
+        expect((cache.has_value()) >> fatal);
+
+        CachingTextLoader::times_decoded = 0;
+        CachingTextLoader::times_cached = 0;
+
+        // every server is a fresh launch sharing the same cache folder.
+        expect(load_length(*cache, "hello") == 5u);
+        expect(CachingTextLoader::times_decoded == 1 && CachingTextLoader::times_cached == 0);
+
+        expect(load_length(*cache, "hello") == 5u);
+        expect(CachingTextLoader::times_decoded == 1 && CachingTextLoader::times_cached == 1);
+
+        // a changed source is decoded again.
+        expect(load_length(*cache, "hello world") == 11u);
+        expect(CachingTextLoader::times_decoded == 2 && CachingTextLoader::times_cached == 1);
+    };
+
+    fs::remove_all(folder);
+}
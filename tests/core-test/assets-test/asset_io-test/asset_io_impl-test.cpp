@@ -1,6 +1,11 @@
 #include <ut.hpp>
 #include <core/assets/asset_io/asset_io_impl.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <array>
+#include <fstream>
 #include <span>
+#include <thread>
 
 using namespace boost::ut;
 namespace fs = std::filesystem;
@@ -13,7 +18,19 @@ void asset_io_impl_test()
         
         { // load a single file
             auto result = io.load_path("pngs/png-image.png")();
-            expect(result.has_value());
+            expect((result.has_value()) >> fatal);
+            expect(result->size() == fs::file_size("assets/pngs/png-image.png"));
+
+            // the bytes outlive the `AssetIo` result they were returned in
+            auto const bytes = *result;
+            result = tl::make_unexpected(AssetIo::Error::NotFound);
+            auto const png_signature = std::array{ std::byte{ 0x89 }, std::byte{ 'P' }, std::byte{ 'N' }, std::byte{ 'G' } };
+            expect(std::equal(png_signature.begin(), png_signature.end(), bytes.begin()));
+        }
+
+        { // load a missing file
+            auto result = io.load_path("pngs/missing.png")();
+            expect(!result.has_value());
         }
 
         { // load a directory
@@ -21,11 +38,134 @@ void asset_io_impl_test()
             expect((result.has_value()) >> fatal);
 
             int num_paths = 0;
-            for (auto const& entry : *result) {
+            for (auto const& path : *result) {
                 ++num_paths;
-                expect(entry.path() == fs::path{ "assets/pngs/png-image.png" });
+                expect(path == fs::path{ "pngs/png-image.png" });
             }
             expect(num_paths == 1);
         }
+
+        { // children of "." are not prefixed with "./"
+            auto result = io.read_directory(".");
+            expect((result.has_value()) >> fatal);
+            expect(std::ranges::find(*result, fs::path{ "pngs" }) != result->end());
+        }
+    };
+
+    "[PackAssetIo]"_test = [] {
+        auto const pack_path = fs::temp_directory_path() / "cngame-test-assets.pack";
+        auto const packed = write_asset_pack("assets", pack_path);
+        expect((packed.has_value()) >> fatal);
+        expect(*packed == 2u);
+
+        auto io = PackAssetIo::open(pack_path);
+        expect((io.has_value()) >> fatal);
+        expect(io->root_path() == pack_path);
+
+        { // load a single file, its bytes match the file they were packed from
+            auto const packed_bytes = io->load_path("pngs/png-image.png")();
+            auto const file_bytes = FileAssetIo("assets").load_path("pngs/png-image.png")();
+            expect((packed_bytes.has_value() && file_bytes.has_value()) >> fatal);
+            expect(std::ranges::equal(packed_bytes->span(), file_bytes->span()));
+            expect(reinterpret_cast<std::uintptr_t>(packed_bytes->data()) % asset_pack::blob_alignment == 0u);
+        }
+
+        { // load a missing file
+            auto const result = io->load_path("pngs/missing.png")();
+            expect(!result.has_value() && result.error() == AssetIo::Error::NotFound);
+        }
+
+        { // directories
+            expect(io->is_directory("."));
+            expect(io->is_directory("pngs"));
+            expect(!io->is_directory("pngs/png-image.png"));
+
+            auto const root = io->read_directory(".");
+            expect((root.has_value()) >> fatal);
+            expect(*root == std::vector<fs::path>{ "bloop_x.wav", "pngs" });
+
+            auto const pngs = io->read_directory("pngs");
+            expect((pngs.has_value()) >> fatal);
+            expect(*pngs == std::vector<fs::path>{ "pngs/png-image.png" });
+
+            expect(!io->read_directory("missing").has_value());
+        }
+
+        { // truncated packs are rejected
+            auto const truncated_path = fs::temp_directory_path() / "cngame-test-truncated.pack";
+            fs::copy_file(pack_path, truncated_path, fs::copy_options::overwrite_existing);
+            fs::resize_file(truncated_path, 64);
+            expect(!PackAssetIo::open(truncated_path).has_value());
+            fs::remove(truncated_path);
+        }
+
+        io = tl::make_unexpected(std::error_code{});
+        fs::remove(pack_path);
+    };
+
+#ifdef __linux__
+    "[FileWatcher]"_test = [] {
+        using namespace std::chrono_literals;
+
+        auto const root = fs::temp_directory_path() / "cngame-test-watched";
+        fs::remove_all(root);
+        fs::create_directories(root / "pngs");
+
+        auto const write = [&root](fs::path const& path, std::string_view const text) {
+            auto out = std::ofstream(root / path, std::ios::binary | std::ios::trunc);
+            out << text;
+        };
+
+        auto watcher = FileWatcher::create(root, 50ms);
+        expect((watcher.has_value()) >> fatal);
+
+        auto const now = FileWatcher::clock::now();
+        expect(watcher->poll(now).empty());
+
+        { // a burst of writes is reported once, after it settled
+            write("a.txt", "1");
+            write("a.txt", "12");
+            write("pngs/b.png", "3");
+
+            expect(watcher->poll(now).empty());
+            expect(watcher->poll(now + 10ms).empty());
+            expect(watcher->poll(now + 60ms) == std::vector<fs::path>{ "a.txt", "pngs/b.png" });
+            expect(watcher->poll(now + 120ms).empty());
+        }
+
+        { // directories created after the watcher are watched as well
+            fs::create_directories(root / "new");
+            expect(watcher->poll(now + 200ms).empty());
+
+            write("new/c.txt", "4");
+            expect(watcher->poll(now + 300ms).empty());
+            expect(watcher->poll(now + 400ms) == std::vector<fs::path>{ "new/c.txt" });
+        }
+
+        { // FileAssetIo only reports changes once it is watching
+            auto file_io = FileAssetIo(root.string());
+            write("a.txt", "5");
+            expect(file_io.changed_paths().empty());
+
+            expect((file_io.watch_for_changes()) >> fatal);
+            write("a.txt", "6");
+
+            auto changed = std::vector<fs::path>{};
+            for (auto attempt = 0; attempt < 100 && changed.empty(); ++attempt) {
+                std::this_thread::sleep_for(10ms);
+                changed = file_io.changed_paths();
+            }
+            expect(changed == std::vector<fs::path>{ "a.txt" });
+
+            // watched files are copied, so truncating one does not pull the bytes out from under a loader.
+            auto const bytes = file_io.load_path("a.txt")();
+            expect((bytes.has_value()) >> fatal);
+            fs::resize_file(root / "a.txt", 0);
+            expect(bytes->span().size() == 1u && bytes->span()[0] == std::byte{ '6' });
+        }
+
+        watcher = tl::make_unexpected(std::error_code{});
+        fs::remove_all(root);
     };
-}
\ No newline at end of file
+#endif
+}
@@ -1,6 +1,9 @@
 #include <ut.hpp>
 #include <core/assets/asset_server.hpp>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace boost::ut;
 
@@ -10,7 +13,7 @@ struct TestAssetIo final : public AssetIo
 {
     auto load_path(std::filesystem::path const&) const -> std::function<Result()> final
     {
-        return []() -> Result { return gbytes; };
+        return []() -> Result { return AssetBytes::from_vector(gbytes); };
     }
 
     auto root_path() const noexcept -> std::filesystem::path final { return std::filesystem::path("."); }
@@ -26,6 +29,69 @@ struct FailingTestAssetIo final : public AssetIo
     auto root_path() const noexcept -> std::filesystem::path final { return std::filesystem::path("."); }
 };
 
+// flags when it is destroyed, the `AssetServer` only holds it as an `AssetIo`.
+struct DroppedTestAssetIo final : public AssetIo
+{
+    std::shared_ptr<bool> dropped;
+
+    explicit DroppedTestAssetIo(std::shared_ptr<bool> d) : dropped(MOV(d)) {}
+    ~DroppedTestAssetIo() final { *dropped = true; }
+
+    auto load_path(std::filesystem::path const&) const -> std::function<Result()> final
+    {
+        return []() -> Result { return AssetBytes::from_vector(gbytes); };
+    }
+
+    auto root_path() const noexcept -> std::filesystem::path final { return std::filesystem::path("."); }
+};
+
+// records the order files are read in, and holds every read until it is opened.
+struct ReadGate
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool is_open = false;
+    std::vector<std::string> reads;
+
+    void read(std::filesystem::path const& path)
+    {
+        auto lock = std::unique_lock(mutex);
+        reads.push_back(path.string());
+        cv.notify_all();
+        cv.wait(lock, [this] { return is_open; });
+    }
+
+    void wait_for_reads(std::size_t const count)
+    {
+        auto lock = std::unique_lock(mutex);
+        cv.wait(lock, [&] { return reads.size() >= count; });
+    }
+
+    void open()
+    {
+        auto const lock = std::scoped_lock(mutex);
+        is_open = true;
+        cv.notify_all();
+    }
+};
+
+struct GatedTestAssetIo final : public AssetIo
+{
+    std::shared_ptr<ReadGate> gate;
+
+    explicit GatedTestAssetIo(std::shared_ptr<ReadGate> g) : gate(MOV(g)) {}
+
+    auto load_path(std::filesystem::path const& path) const -> std::function<Result()> final
+    {
+        return [gate = gate, path]() -> Result {
+            gate->read(path);
+            return AssetBytes::from_vector(gbytes);
+        };
+    }
+
+    auto root_path() const noexcept -> std::filesystem::path final { return std::filesystem::path("."); }
+};
+
 constexpr std::string_view asset_ext = "hello";
 constexpr std::string_view asset_path = "a/b/c/file.hello";
 constexpr std::string_view asset_path2 = "a/b/sup.hello";
@@ -42,7 +108,7 @@ struct TestAssetLoader final : AssetLoader
         return std::span{ exts.data(), 1 };
     }
 
-    auto load(std::filesystem::path const&, std::span<std::byte> bytes) const -> tl::optional<LoadedAsset> final
+    auto load(std::filesystem::path const&, std::span<std::byte const> bytes) const -> tl::optional<LoadedAsset> final
     {
         ++times_loaded;
         return LoadedAsset::create<TestAsset>();
@@ -58,7 +124,7 @@ struct FailingTestAssetLoader final : AssetLoader
         return std::span{ exts.data(), 1 };
     }
 
-    auto load(std::filesystem::path const&, std::span<std::byte> bytes) const -> tl::optional<LoadedAsset> final
+    auto load(std::filesystem::path const&, std::span<std::byte const> bytes) const -> tl::optional<LoadedAsset> final
     {
         return tl::nullopt;
     }
@@ -73,6 +139,21 @@ void asset_server_test()
 
         server.add_asset_loader<TestAssetLoader>();
 
+        should("add asset loaders while others are looked up") = [&] {
+            auto done = std::atomic<bool>{ false };
+            auto lookups = std::thread([&] {
+                while (!done.load()) {
+                    UNUSED(server.get_asset_loader_from_extension(asset_ext));
+                }
+            });
+            for (int i = 0; i < 100; ++i) {
+                server.add_asset_loader<TestAssetLoader>();
+            }
+            done = true;
+            lookups.join();
+            expect(server.get_asset_loader_from_extension(asset_ext).has_value());
+        };
+
         should("contains asset loader for extension") = [&] {
             expect(server.get_asset_loader_from_extension(asset_ext).has_value());
             expect(server.get_asset_loader_from_path(asset_path).has_value());
@@ -157,6 +238,92 @@ void asset_server_test()
         };
     };
 
+    "[AssetServer]: Reload"_test = [] {
+        auto server = AssetServer(std::make_unique<TestAssetIo>(), TaskPool{});
+        auto assets = server.register_asset_type<TestAsset>();
+        server.add_asset_loader<TestAssetLoader>();
+
+        auto events = Events<AssetEvent<TestAsset>>();
+        auto reader = events.get_reader();
+        auto const next_event = [&] {
+            server.update_assets(assets);
+            assets.update_events(events);
+            auto iter = reader.iter(events);
+            return iter.size() == 1 ? tl::make_optional((*iter.begin()).type) : tl::nullopt;
+        };
+
+        should("not load assets that were never loaded") = [&] {
+            auto const loaded = TestAssetLoader::times_loaded.load();
+            expect(server.reload_sync(asset_path).has_value());
+            expect(TestAssetLoader::times_loaded == loaded);
+            expect(server.get_load_state(HandleId::from_path(asset_path)) == LoadState::NotLoaded);
+        };
+
+        should("replace a loaded asset") = [&] {
+            expect((server.load_sync(asset_path).has_value()) >> fatal);
+            expect(next_event() == AssetEvent<TestAsset>::Created);
+
+            auto const loaded = TestAssetLoader::times_loaded.load();
+            expect((server.reload_sync(asset_path).has_value()) >> fatal);
+            expect(TestAssetLoader::times_loaded == loaded + 1);
+            expect(server.get_load_state(HandleId::from_path(asset_path)) == LoadState::Loaded);
+
+            expect(next_event() == AssetEvent<TestAsset>::Modified);
+            expect(assets.size() == 1u);
+        };
+    };
+
+    "[AssetServer]: Load queue"_test = [] {
+        auto gate = std::make_shared<ReadGate>();
+        auto server = AssetServer(std::make_unique<GatedTestAssetIo>(gate), TaskPool{});
+        auto assets = server.register_asset_type<TestAsset>();
+        server.add_asset_loader<TestAssetLoader>();
+        server.set_load_limits(AssetLoadLimits{ .max_reads = 1, .max_decodes = 1 });
+
+        // the only read allowed in flight, every load below has to queue behind it.
+        auto const first = server.load<TestAsset>("first.hello", LoadPriority::Prefetch);
+        gate->wait_for_reads(1);
+
+        auto const prefetch = server.load<TestAsset>("prefetch.hello", LoadPriority::Prefetch);
+        auto const promoted = server.load<TestAsset>("promoted.hello", LoadPriority::Prefetch);
+        auto const visible = server.load<TestAsset>("visible.hello", LoadPriority::Visible);
+        auto const highest = server.load<TestAsset>("highest.hello", LoadPriority::Highest);
+        auto const promoted_again = server.load<TestAsset>("promoted.hello", LoadPriority::Visible);
+        {
+            auto const dropped = server.load<TestAsset>("dropped.hello", LoadPriority::Highest);
+        }
+        expect(server.queued_load_count() == 5u);
+
+        should("cancel loads without handles") = [&] {
+            server.update_asset_ref_count();
+            expect(server.queued_load_count() == 4u);
+            expect(server.get_load_state(HandleId::from_path("dropped.hello")) == LoadState::NotLoaded);
+        };
+
+        should("load in priority order") = [&] {
+            gate->open();
+            for (;;) {
+                server.update_assets(assets);
+                if (assets.size() == 5) {
+                    break;
+                }
+                std::this_thread::yield();
+            }
+
+            auto const lock = std::scoped_lock(gate->mutex);
+            expect(gate->reads == std::vector<std::string>{ "first.hello", "highest.hello", "visible.hello", "promoted.hello", "prefetch.hello" });
+            expect(server.get_load_state(promoted_again) == LoadState::Loaded);
+        };
+    };
+
+    "[AssetServer]: Drops its AssetIo"_test = [] {
+        auto const dropped = std::make_shared<bool>(false);
+        {
+            auto server = AssetServer(std::make_unique<DroppedTestAssetIo>(dropped), TaskPool{});
+        }
+        expect(*dropped);
+    };
+
     "[AssetServer]: Handle Garbage Collection"_test = [] {
         // TODO
         auto useless_handle = [] {
@@ -251,5 +418,19 @@ void asset_server_test()
             update();
             expect(!assets.contains_asset(id));
         };
+
+        should("remove asset when a handle made typed exits scope") = [&] {
+            auto id = HandleId::random<int>();
+
+            {
+                auto handle = assets.add_asset(42).untyped().typed<int>();
+                id = handle.id();
+                update();
+                expect(assets.contains_asset(id));
+            }
+
+            update();
+            expect(!assets.contains_asset(id));
+        };
     };
 }
\ No newline at end of file
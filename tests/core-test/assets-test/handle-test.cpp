@@ -1,5 +1,7 @@
 #include <core/assets/handle.hpp>
 #include <ut.hpp>
+#include <array>
+#include <new>
 #include <unordered_map>
 
 using namespace boost::ut;
@@ -29,4 +31,47 @@ void handle_test()
         UNUSED(MOV(untyped_int_handle).typed<int>());
         UNUSED(MOV(untyped_char_handle).typed<char>());
     };
+
+    "[HandleId] from_path"_test = [] {
+        expect(HandleId::from_path("./pngs/x.png") == HandleId::from_path("pngs/x.png"));
+        expect(HandleId::from_path("pngs/../x.png") == HandleId::from_path("x.png"));
+        expect(HandleId::from_path("pngs/x.png") != HandleId::from_path("x.png"));
+    };
+
+    "[Handle] typed keeps the strong reference"_test = [] {
+        auto channel = RefChangeChannel::create();
+        auto const id = HandleId::from_path("an-int-file");
+
+        auto count = 0;
+        auto const drain = [&] {
+            while (auto const change = channel.receiver.recv()) {
+                count += change->type == RefChange::Increment ? 1 : -1;
+            }
+        };
+
+        {
+            auto handle = UntypedHandle::strong(id, channel.sender).typed<int>();
+            drain();
+            expect(count == 1);
+        }
+        drain();
+        expect(count == 0);
+    };
+
+    "[HandleId] equal ids hash the same"_test = [] {
+        // the bytes of the union the path id does not use are left as they were.
+        alignas(HandleId) std::array<std::byte, sizeof(HandleId)> zeros{};
+        alignas(HandleId) std::array<std::byte, sizeof(HandleId)> ones{};
+        ones.fill(std::byte{ 0xff });
+
+        auto const& id1 = *new (zeros.data()) HandleId(AssetPathId{ .id = 7 });
+        auto const& id2 = *new (ones.data()) HandleId(AssetPathId{ .id = 7 });
+
+        expect(id1 == id2);
+        expect(std::hash<HandleId>{}(id1) == std::hash<HandleId>{}(id2));
+
+        auto ids = std::unordered_map<HandleId, int>{};
+        ids.emplace(id1, 1);
+        expect(ids.contains(id2));
+    };
 }
\ No newline at end of file
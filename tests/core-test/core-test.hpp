@@ -1,32 +1,50 @@
 #pragma once
 
+void access_test();
+void asset_cache_test();
 void asset_server_test();
 void assets_test();
 void asset_io_impl_test();
+void diagnostics_test();
 void events_test();
+void frame_pacer_test();
 void game_test();
 void handle_test();
 void input_test();
 void mouse_test();
+void parallel_events_test();
+void query_test();
 void resource_test();
 void runner_test();
 void scheduler_test();
 void system_test();
+void task_pool_test();
 void texture_test();
+void time_test();
+void trace_test();
 
 void core_test()
 {
+    access_test();
+    asset_cache_test();
     asset_server_test();
     assets_test();
     asset_io_impl_test();
+    diagnostics_test();
     events_test();
+    frame_pacer_test();
     game_test();
     handle_test();
     input_test();
     mouse_test();
+    parallel_events_test();
+    query_test();
     resource_test();
     runner_test();
     scheduler_test();
     system_test();
+    task_pool_test();
     texture_test();
+    time_test();
+    trace_test();
 }
\ No newline at end of file
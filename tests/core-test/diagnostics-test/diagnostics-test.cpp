@@ -0,0 +1,77 @@
+#include <ut.hpp>
+#include <core/diagnostics/diagnostics.hpp>
+#include <core/ecs/scheduler.hpp>
+#include <chrono>
+#include <thread>
+
+using namespace boost::ut;
+
+struct DiagnosticsTestStage {};
+
+void diagnostics_test()
+{
+    using namespace std::chrono_literals;
+    using dur_t = DiagnosticStats::dur_t;
+
+    "[SampleRing]"_test = [] {
+        auto ring = SampleRing<4>{};
+        expect(ring.stats().samples == 0);
+        expect(!ring.latest().has_value());
+
+        for (int i = 1; i <= 6; ++i) {
+            ring.push(static_cast<float>(i));
+        }
+
+        should("only keep the most recent samples") = [&] {
+            auto const stats = ring.stats();
+            expect(stats.samples == 4);
+            expect(stats.min == dur_t(3.f));
+            expect(stats.max == dur_t(6.f));
+            expect(stats.avg == dur_t(4.5f));
+            expect(stats.p99 == dur_t(6.f));
+            expect(*ring.latest() == 6.f);
+        };
+    };
+
+    "[Diagnostics]"_test = [] {
+        auto r = Resources{};
+        r.set_resource<Diagnostics>();
+        auto w = World{};
+
+        auto sleeper = [](Resource<Diagnostics const>) { std::this_thread::sleep_for(1ms); };
+
+        auto scheduler = Scheduler{};
+        scheduler.add_stage<DiagnosticsTestStage>();
+        auto const id = scheduler.add_system_to_stage<DiagnosticsTestStage>(sleeper);
+
+        for (int i = 0; i < 3; ++i) {
+            scheduler.run_stages(r, w);
+        }
+
+#ifdef ENABLE_DIAGNOSTICS
+        auto const diagnostics = r.get_resource<Diagnostics const>();
+        expect((diagnostics.has_value()) >> fatal);
+
+        should("record every system") = [&] {
+            auto const system = (*diagnostics)->system(id);
+            expect((system.has_value()) >> fatal);
+            expect(system->stats().samples == 3);
+            expect(system->stats().min >= 1ms);
+        };
+
+        should("record every stage") = [&] {
+            auto const stage = (*diagnostics)->stage<DiagnosticsTestStage>();
+            expect((stage.has_value()) >> fatal);
+            expect(stage->stats().samples == 3);
+        };
+
+        should("record the whole frame") = [&] {
+            auto const stats = (*diagnostics)->frame().stats();
+            expect(stats.samples == 3);
+            expect(stats.min >= 1ms);
+        };
+#else
+        UNUSED(id);
+#endif
+    };
+}
@@ -0,0 +1,91 @@
+#include <ut.hpp>
+#include <core/diagnostics/trace.hpp>
+#include <core/ecs/scheduler.hpp>
+#include <core/task/task_pool.hpp>
+#include <algorithm>
+#include <string_view>
+
+using namespace boost::ut;
+
+struct TraceTestStage {};
+
+void trace_test()
+{
+    "[Tracer]"_test = [] {
+        auto& tracer = Tracer::instance();
+
+        should("not record outside of a capture") = [&] {
+            {
+                auto const scope = TraceScope("ignored", "test");
+            }
+            tracer.begin_capture();
+            auto const capture = tracer.end_capture();
+            expect(capture.events.empty());
+        };
+
+        should("record spans of every thread") = [&] {
+            auto pool = TaskPool(2);
+            tracer.begin_capture();
+            {
+                auto const scope = TraceScope("outer", "test");
+                pool.scope([](auto& s) {
+                    for (int i = 0; i < 4; ++i) {
+                        s.spawn([] { auto const scope = TraceScope("inner", "test"); });
+                    }
+                });
+            }
+            auto const capture = tracer.end_capture();
+
+            expect(capture.events.size() == 5);
+            expect(std::ranges::count(capture.events, std::string_view("inner"), &TraceEvent::name) == 4);
+
+            auto const outer = std::ranges::find(capture.events, std::string_view("outer"), &TraceEvent::name);
+            expect((outer != capture.events.end()) >> fatal);
+            expect(outer->begin >= capture.start);
+            expect(outer->end >= outer->begin);
+        };
+
+        should("drop events once the thread buffer is full") = [&] {
+            tracer.begin_capture();
+            for (std::size_t i = 0; i < trace_detail::ThreadTraceBuffer::capacity + 10; ++i) {
+                auto const scope = TraceScope("spam", "test");
+            }
+            auto const capture = tracer.end_capture();
+            expect(capture.events.size() == trace_detail::ThreadTraceBuffer::capacity);
+            expect(capture.dropped == 10);
+        };
+    };
+
+    "[Trace JSON]"_test = [] {
+        auto const start = TraceEvent::clock_t::now();
+        auto const capture = Tracer::Capture{
+            .events = { TraceEvent{ .name = "a \"quoted\" name", .category = "test", .begin = start, .end = start, .thread = 3 } },
+            .start = start,
+        };
+
+        auto const json = trace_to_json(capture);
+        expect(json == R"({"displayTimeUnit":"ms","traceEvents":[{"name":"a \"quoted\" name","cat":"test","ph":"X","ts":0.000,"dur":0.000,"pid":0,"tid":3}]})");
+    };
+
+#ifdef ENABLE_DIAGNOSTICS
+    "[TraceCapture]"_test = [] {
+        auto r = Resources{};
+        r.set_resource<TraceCapture>()->capture(2, "trace-test.json");
+        auto w = World{};
+
+        auto scheduler = Scheduler{};
+        scheduler.add_stage<TraceTestStage>();
+        scheduler.add_system_to_stage<TraceTestStage>(trace_capture_system);
+
+        scheduler.run_stages(r, w);
+        expect(Tracer::instance().is_capturing());
+        expect(r.get_resource<TraceCapture>().map([](auto c) { return c->is_capturing(); }).value_or(false));
+
+        scheduler.run_stages(r, w);
+        scheduler.run_stages(r, w);
+        expect(!Tracer::instance().is_capturing());
+        expect(std::filesystem::exists("trace-test.json"));
+        std::filesystem::remove("trace-test.json");
+    };
+#endif
+}
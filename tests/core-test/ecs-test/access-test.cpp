@@ -0,0 +1,97 @@
+#include <ut.hpp>
+#include <core/ecs/access.hpp>
+#include <core/ecs/scheduler.hpp>
+#include <core/ecs/system.hpp>
+#include <atomic>
+
+using namespace boost::ut;
+
+namespace access_test_ns {
+    struct ResA {};
+    struct ResB {};
+    struct CompA {};
+    struct CompB {};
+
+    void read_a(Resource<ResA const>) {}
+    void read_a2(Resource<ResA const>, Resource<ResB const>) {}
+    void write_a(Resource<ResA>) {}
+    void write_b(Resource<ResB>) {}
+    void read_comp_a(Query<With<CompA const>>) {}
+    void write_comp_a(Query<With<CompA>>) {}
+    void write_comp_b(Query<With<CompB>, Without<CompA>>) {}
+    void changed_comp_a(Query<With<CompB const, Changed<CompA>>>) {}
+    void commands(Commands) {}
+    void event_reader(EventReader<int>) {}
+    void event_writer(EventWriter<int>) {}
+
+    template <typename F, typename G>
+    auto conflicts(F& f, G& g) -> bool
+    {
+        return System::create(f).access().conflicts_with(System::create(g).access());
+    }
+}
+
+struct AccessTestStage {};
+
+void access_test()
+{
+    using namespace access_test_ns;
+
+    "[SystemAccess]"_test = [] {
+        should("not conflict on shared reads") = [] {
+            expect(!conflicts(read_a, read_a2));
+            expect(!conflicts(read_comp_a, read_comp_a));
+            expect(!conflicts(read_comp_a, changed_comp_a));
+            expect(!conflicts(event_reader, event_reader));
+        };
+
+        should("conflict when one side writes") = [] {
+            expect(conflicts(read_a, write_a));
+            expect(conflicts(write_a, write_a));
+            expect(conflicts(read_comp_a, write_comp_a));
+            expect(conflicts(write_comp_b, write_comp_a));
+            expect(conflicts(changed_comp_a, write_comp_a));
+            expect(conflicts(event_reader, event_writer));
+        };
+
+        should("not conflict on disjoint writes") = [] {
+            expect(!conflicts(write_a, write_b));
+            expect(!conflicts(write_a, write_comp_a));
+            expect(!conflicts(read_a2, write_comp_b));
+        };
+
+        should("not conflict through deferred commands") = [] {
+            expect(!conflicts(commands, read_a));
+            expect(!conflicts(write_comp_a, commands));
+            expect(!conflicts(commands, commands));
+        };
+    };
+
+    "[Stage]: Parallel Batches"_test = [] {
+        auto r = Resources{};
+        r.set_resource<ResA>();
+        r.set_resource<ResB>();
+        r.set_resource<TaskPool>(2);
+        auto w = World{};
+
+        std::atomic<int> ran{ 0 };
+        auto reader1 = [&](Resource<ResA const>) { ++ran; };
+        auto reader2 = [&](Resource<ResA const>, Resource<ResB const>) { ++ran; };
+        auto writer = [&](Resource<ResA>) { ++ran; };
+        auto reader3 = [&](Resource<ResB const>) { ++ran; };
+
+        auto stage = Stage::create<AccessTestStage>();
+        stage.add_system(System::create(reader1));
+        stage.add_system(System::create(reader2));
+        stage.add_system(System::create(writer));
+        stage.add_system(System::create(reader3));
+
+        stage.run(r, w);
+        expect(ran == 4);
+
+        auto const& batches = stage.batches();
+        expect((batches.size() == 2) >> fatal);
+        expect(batches[0] == std::vector<std::size_t>{ 0, 1, 3 });
+        expect(batches[1] == std::vector<std::size_t>{ 2 });
+    };
+}
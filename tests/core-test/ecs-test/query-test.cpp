@@ -0,0 +1,235 @@
+#include <ut.hpp>
+#include <core/ecs/query.hpp>
+#include <core/ecs/scheduler.hpp>
+#include <core/ecs/system.hpp>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+using namespace boost::ut;
+
+struct QueryTestStage {};
+
+namespace query_test_change_detection {
+    struct Seen
+    {
+        std::vector<int> added;
+        std::vector<int> changed;
+
+        void sort()
+        {
+            std::ranges::sort(added);
+            std::ranges::sort(changed);
+        }
+    };
+
+    entity_t marked = null_entity;
+
+    void added_system(Query<With<int const, Added<int>>> q, Resource<Seen> seen)
+    {
+        q.each([&seen](int const i) { seen->added.push_back(i); });
+    }
+
+    void changed_system(Query<With<int const, Changed<int>>> q, Resource<Seen> seen)
+    {
+        q.par_each(2, [&seen](int const i) { seen->changed.push_back(i); });
+    }
+
+    void mark_system(Commands commands)
+    {
+        if (marked != null_entity) {
+            commands.mark_changed<int>(std::exchange(marked, null_entity));
+        }
+    }
+
+    tl::optional<int> to_spawn;
+
+    void spawn_system(Commands commands)
+    {
+        if (to_spawn) {
+            commands.spawn().add_component<int>(*std::exchange(to_spawn, tl::nullopt));
+        }
+    }
+}
+
+void query_test()
+{
+    "[Query]: par_each"_test = [] {
+        auto w = World{};
+        for (int i = 0; i < 10'000; ++i) {
+            auto const e = w.create();
+            w.emplace<int>(e, i);
+            if (i % 2 == 0) {
+                w.emplace<char>(e, 'a');
+            }
+        }
+
+        auto pool = TaskPool(4);
+
+        should("visit every entity exactly once") = [&] {
+            auto query = Query<With<int>>(w.view<int>(), &pool);
+
+            std::atomic<long long> sum{ 0 };
+            query.par_each(128, [&sum](int& i) {
+                sum += i;
+                i *= 2;
+            });
+            expect(sum == 49'995'000);
+
+            sum = 0;
+            query.par_each(128, [&sum](int const& i) { sum += i; });
+            expect(sum == 99'990'000);
+        };
+
+        should("respect Without<>") = [&] {
+            auto query = Query<With<int const>, Without<char>>(w.view<int const>(entt::exclude<char>), &pool);
+
+            std::atomic<int> count{ 0 };
+            query.par_each(100, [&count](int const&) { ++count; });
+            expect(count == 5'000);
+        };
+
+        should("skip entities of the leading storage that miss a component") = [&] {
+            auto query = Query<With<int const, char const>>(w.view<int const, char const>(), &pool);
+
+            std::atomic<int> count{ 0 };
+            query.par_each(100, [&count](int const&, char const&) { ++count; });
+            expect(count == 5'000);
+        };
+
+        should("run on the calling thread without a TaskPool") = [&] {
+            auto query = Query<With<int const>>(w.view<int const>());
+
+            std::atomic<int> count{ 0 };
+            query.par_each(64, [&count](int const&) { ++count; });
+            expect(count == 10'000);
+        };
+
+        should("hand the entity to a function that takes one") = [&] {
+            auto query = Query<With<int const>>(w.view<int const>(), &pool);
+
+            std::atomic<int> mismatches{ 0 };
+            query.par_each(128, [&w, &mismatches](entity_t const e, int const& i) {
+                if (std::addressof(w.get<int>(e)) != std::addressof(i)) {
+                    ++mismatches;
+                }
+            });
+            expect(mismatches == 0);
+        };
+    };
+
+    "[Query]: par_each from a System"_test = [] {
+        auto r = Resources{};
+        r.set_resource<TaskPool>(2);
+        auto w = World{};
+        for (int i = 0; i < 1'000; ++i) {
+            w.emplace<int>(w.create(), 1);
+        }
+
+        auto increment = [](Query<With<int>> q) { q.par_each(10, [](int& i) { ++i; }); };
+
+        auto stage = Stage::create<QueryTestStage>();
+        stage.add_system(System::create(increment));
+        stage.run(r, w);
+
+        int sum = 0;
+        w.view<int>().each([&sum](int const i) { sum += i; });
+        expect(sum == 2'000);
+    };
+
+    "[Query]: Added and Changed filters"_test = [] {
+        using namespace query_test_change_detection;
+
+        auto r = Resources{};
+        r.set_resource<Seen>();
+        auto w = World{};
+
+        auto entities = std::vector<entity_t>{};
+        for (int i = 0; i < 3; ++i) {
+            entities.push_back(w.create());
+            w.emplace<int>(entities.back(), i);
+        }
+
+        auto stage = Stage::create<QueryTestStage>();
+        stage.add_system(System::create(added_system));
+        stage.add_system(System::create(changed_system));
+        stage.add_system(System::create(mark_system));
+
+        auto const run = [&] {
+            auto seen = r.get_resource<Seen>();
+            **seen = Seen{};
+            stage.run(r, w);
+            (*seen)->sort();
+            return **seen;
+        };
+
+        should("match existing components on the first run") = [&] {
+            auto const seen = run();
+            expect(seen.added == std::vector{ 0, 1, 2 });
+            expect(seen.changed == std::vector{ 0, 1, 2 });
+        };
+
+        should("match nothing if nothing changed") = [&] {
+            auto const seen = run();
+            expect(seen.added.empty());
+            expect(seen.changed.empty());
+        };
+
+        should("match added and patched components") = [&] {
+            w.emplace<int>(w.create(), 3);
+            w.patch<int>(entities[1]);
+
+            auto const seen = run();
+            expect(seen.added == std::vector{ 3 });
+            expect(seen.changed == std::vector{ 1, 3 });
+        };
+
+        should("match components marked by Commands once they are applied") = [&] {
+            marked = entities[2];
+            expect(run().changed.empty());
+
+            auto const seen = run();
+            expect(seen.added.empty());
+            expect(seen.changed == std::vector{ 2 });
+        };
+
+        should("forget removed components") = [&] {
+            w.remove<int>(entities[0]);
+            w.emplace<int>(entities[0], 10);
+
+            auto const seen = run();
+            expect(seen.added == std::vector{ 10 });
+            expect(seen.changed == std::vector{ 10 });
+        };
+    };
+
+    "[Query]: Added filter after Commands"_test = [] {
+        using namespace query_test_change_detection;
+
+        auto r = Resources{};
+        r.set_resource<Seen>();
+        auto w = World{};
+
+        // without a `TaskPool` the systems run in order, so `added_system` is the last to advance the tick
+        // before the commands are applied.
+        auto stage = Stage::create<QueryTestStage>();
+        stage.add_system(System::create(spawn_system));
+        stage.add_system(System::create(added_system));
+
+        auto const run = [&] {
+            auto seen = r.get_resource<Seen>();
+            **seen = Seen{};
+            stage.run(r, w);
+            return (*seen)->added;
+        };
+
+        to_spawn = 7;
+        expect(run().empty());
+        expect(run() == std::vector{ 7 });
+        expect(run().empty());
+
+        // changes made between runs count as well.
+        w.emplace<int>(w.create(), 8);
+        expect(run() == std::vector{ 8 });
+    };
+}
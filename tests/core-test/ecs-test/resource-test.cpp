@@ -1,3 +1,6 @@
+#include <atomic>
+#include <thread>
+#include <vector>
 #include "ut.hpp"
 #include "core/ecs/resource.hpp"
 
@@ -73,6 +76,70 @@ void resource_test()
             expect(!rm.get_resource<int>().has_value());
         };
 
+        should("borrow resources") = [&rm] {
+            rm.set_resource<int>(7);
+            auto const state = rm.borrow_state<int>();
+            expect((state != nullptr) >> fatal);
+
+            {
+                auto read1 = rm.read_resource<int>();
+                auto read2 = std::as_const(rm).read_resource<int>();
+                static_assert(std::is_same_v<std::remove_cvref_t<decltype(*read1)>, ResourceReadGuard<int>>);
+                expect((read1.has_value() && read2.has_value()) >> fatal);
+                expect(**read1 == 7 && **read2 == 7);
+#ifdef IS_DEBUG
+                expect(state->is_borrowed());
+#endif
+            }
+            expect(!state->is_borrowed());
+
+            {
+                auto write = rm.write_resource<int>();
+                expect(write.has_value() >> fatal);
+                **write = 8;
+
+                auto moved = MOV(*write);
+                expect(*moved == 8);
+            }
+            expect(!state->is_borrowed());
+            expect(!rm.read_resource<char>().has_value());
+            expect(rm.remove_resource<int>() != nullptr);
+
+            // the borrow state outlives the removed entry.
+            expect(!state->is_borrowed());
+        };
+
+        should("look up resources from other threads") = [] {
+            Resources resources;
+            resources.set_resource<int>(0);
+
+            auto misses = std::atomic<int>{ 0 };
+            auto threads = std::vector<std::thread>{};
+            for (int i = 0; i < 4; ++i) {
+                threads.emplace_back([&resources, &misses, i] {
+                    for (int j = 0; j < 100; ++j) {
+                        if (!resources.read_resource<int>().has_value()) {
+                            misses.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        if (i == 0) {
+                            resources.try_add_resource<float>(1.0f);
+                            resources.remove_resource<double>();
+                        }
+                        else {
+                            resources.try_add_resource<double>(2.0);
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            expect(misses.load() == 0);
+            expect(resources.contains_resource<float>());
+            expect(**resources.get_resource<int>() == 0);
+        };
+
         SystemId const id1 = SystemId::create<int>();
         SystemId const id2 = SystemId::create<float>();
 
@@ -124,7 +191,22 @@ void resource_test()
             expect(rm.local().remove_local_resource<char>(id2) != nullptr);
             expect(!rm.local().contains_local_resource<char>(id2));
             expect(!rm.local().get_local_resource<char>(id2).has_value());
+        };
+
+        should("not hand the locals of a released system to the system reusing its index") = [&] {
+            auto other = Resources{};
+            SystemId const id3 = SystemId::create<double>();
+            other.local().set_local_resource<int>(id3, 3);
+
+            SystemId::release(id3);
+            SystemId const id4 = SystemId::create<double>();
+            expect(id4.index == id3.index);
+            expect(id4 != id3);
+            expect(!other.local().contains_local_resource<int>(id4));
 
+            other.local().set_local_resource<int>(id4, 4);
+            expect(!other.local().contains_local_resource<int>(id3));
+            expect(other.local().get_local_resource<int>(id4).map([](auto l) { return *l; }) == 4);
         };
     };
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include <core/ecs/scheduler.hpp>
 #include <core/ecs/resource.hpp>
 #include <core/ecs/scheduler.hpp>
+#include <atomic>
 
 using namespace boost::ut;
 
@@ -12,6 +13,11 @@ struct Stage2 {};
 struct Stage3 {};
 struct Stage4 {};
 
+struct FirstLabel {};
+struct SecondLabel {};
+
+struct Ping {};
+
 enum class StageCount
 {
     One, Two, Three, Four,
@@ -48,4 +54,80 @@ void scheduler_test()
 
         expect(count == std::vector{ StageCount::One, StageCount::Two, StageCount::Three, StageCount::Four });
     };
-}
\ No newline at end of file
+
+    "[Stage]: Ordering Labels"_test = [&] {
+        auto r = Resources{};
+        r.set_resource<AResource>();
+        auto w = World{};
+
+        should("run labeled systems in order regardless of insertion order") = [&] {
+            count.clear();
+
+            auto stage = Stage::create<Stage2>();
+            stage.add_system(System::create(system3)).after(SystemLabel::create<SecondLabel>());
+            stage.add_system(System::create(system2)).label(SystemLabel::create<SecondLabel>()).after(SystemLabel::create<FirstLabel>());
+            stage.add_system(System::create(system4));
+            stage.add_system(System::create(system1)).before(SystemLabel::create<SecondLabel>()).label(SystemLabel::create<FirstLabel>());
+            stage.run(r, w);
+
+            // unordered systems keep their insertion order
+            expect(count == std::vector{ StageCount::Four, StageCount::One, StageCount::Two, StageCount::Three });
+        };
+
+        should("only split batches where the ordering requires it") = [&] {
+            auto reader = [](Resource<AResource const>) {};
+            auto reader2 = [](Resource<AResource const>) {};
+            auto reader3 = [](Resource<AResource const>) {};
+
+            auto stage = Stage::create<Stage2>();
+            stage.add_system(System::create(reader)).after(SystemLabel::create<FirstLabel>());
+            stage.add_system(System::create(reader2)).label(SystemLabel::create<FirstLabel>());
+            stage.add_system(System::create(reader3));
+            stage.build();
+
+            expect(stage.batches() == std::vector<std::vector<std::size_t>>{ { 1, 2 }, { 0 } });
+        };
+    };
+
+    "[Stage]: Prepared before a parallel batch"_test = [] {
+        auto r = Resources{};
+        r.set_resource<TaskPool>(2);
+        r.set_resource<Events<Ping>>();
+        auto w = World{};
+        w.emplace<int>(w.create(), 1);
+        w.emplace<char>(w.create(), 'a');
+
+        // every argument adds a local or a resource when it is resolved, which makes the systems resolved
+        // before it stale. they must still be up to date before the batch runs on the workers.
+        std::atomic<int> pings_read{ 0 };
+        std::atomic<int> ints_changed{ 0 };
+        std::atomic<int> chars_changed{ 0 };
+        auto read_pings = [&](EventReader<Ping> reader, Query<With<int const, Changed<int>>> ints) {
+            for (auto const& ping : reader.iter()) {
+                UNUSED(ping);
+                ++pings_read;
+            }
+            ints.each([&](int const) { ++ints_changed; });
+        };
+        auto spawn_chars = [&](Commands commands, Query<With<char const, Changed<char>>> chars) {
+            chars.each([&](char const) { ++chars_changed; });
+            commands.spawn().add_component<char>('b');
+        };
+
+        auto stage = Stage::create<Stage2>();
+        stage.add_system(System::create(read_pings));
+        stage.add_system(System::create(spawn_chars));
+        stage.build();
+        expect(stage.batches() == std::vector<std::vector<std::size_t>>{ { 0, 1 } });
+
+        stage.run(r, w);
+        expect(ints_changed == 1);
+        expect(chars_changed == 1);
+
+        (*r.get_resource<Events<Ping>>())->send(Ping{});
+        stage.run(r, w);
+        expect(pings_read == 1);
+        expect(ints_changed == 1);
+        expect(chars_changed == 2);
+    };
+}
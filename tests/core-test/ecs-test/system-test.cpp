@@ -2,6 +2,9 @@
 #include "core/ecs/system.hpp"
 #include "core/ecs/scheduler.hpp"
 #include "core/ecs/resource.hpp"
+#include <optional>
+#include <span>
+#include <vector>
 
 using namespace boost::ut;
 
@@ -20,6 +23,49 @@ namespace funcs {
     void event_reader(EventReader<int>) {}
 }
 
+namespace system_test_bundles {
+    struct Position { int x; };
+    struct Tag {};
+
+    struct PlainBundle
+    {
+        int value;
+
+        void build(World& world) &&
+        {
+            world.emplace<int>(world.create(), value);
+        }
+    };
+
+    struct BatchedBundle
+    {
+        Position position;
+        bool tagged = false;
+
+        static inline std::size_t batches = 0;
+
+        void build(World& world) &&
+        {
+            auto const e = world.create();
+            world.emplace<Position>(e, position);
+            if (tagged) {
+                world.emplace<Tag>(e);
+            }
+        }
+
+        static void build_batch(World& world, std::span<entity_t const> const entities, std::span<BatchedBundle> const bundles)
+        {
+            ++batches;
+            insert_components<Position>(world, entities, [&](std::size_t const i) { return bundles[i].position; });
+            for (std::size_t i = 0; i < entities.size(); ++i) {
+                if (bundles[i].tagged) {
+                    world.emplace<Tag>(entities[i]);
+                }
+            }
+        }
+    };
+}
+
 namespace system_test_execute {
     int global_count = 0;
 
@@ -73,6 +119,34 @@ void system_test()
             expect(*local1 == 1);
             expect(*local2 == 100);
         };
+
+        should("give the same function registered twice its own locals") = [&] {
+            auto system3 = System::create(increment_local);
+            auto system4 = System::create(increment_local);
+            expect(system3.id() != system4.id());
+
+            r.local().set_local_resource<int>(system3.id(), 0);
+            r.local().set_local_resource<int>(system4.id(), 0);
+
+            system3.run(r, w);
+            system3.run(r, w);
+            system4.run(r, w);
+
+            expect(*r.local().get_local_resource<int>(system3.id()).value() == 2);
+            expect(*r.local().get_local_resource<int>(system4.id()).value() == 1);
+        };
+
+        should("start a system reusing a dropped system's index without its locals") = [&] {
+            auto dropped = tl::make_optional(System::create(increment_local));
+            auto const dropped_id = dropped->id();
+            r.local().set_local_resource<int>(dropped_id, 0);
+            dropped->run(r, w);
+            dropped.reset();
+
+            auto system5 = System::create(increment_local);
+            expect(system5.id().index == dropped_id.index);
+            expect(!r.local().contains_local_resource<int>(system5.id()));
+        };
     };
 
     "[Execute System]"_test = [] {
@@ -103,6 +177,74 @@ void system_test()
         };
     };
 
+    "[Execute System: Cached Arguments]"_test = [] {
+        auto r = Resources{};
+        auto w = World{};
+
+        int seen = 0;
+        auto read_int = [&](Resource<int const> i) { seen = *i; };
+        auto system = System::create(read_int);
+
+        r.set_resource<int>(1);
+        system.run(r, w);
+        expect(seen == 1);
+
+        should("not change generation when modifying a resource") = [&] {
+            auto const generation = r.generation();
+            **r.get_resource<int>() = 2;
+            system.run(r, w);
+            expect(seen == 2);
+            expect(r.generation() == generation);
+        };
+
+        should("re-resolve a replaced resource") = [&] {
+            auto const generation = r.generation();
+            r.set_resource<int>(3);
+            expect(r.generation() != generation);
+            system.run(r, w);
+            expect(seen == 3);
+        };
+
+        should("re-resolve when run with other resources") = [&] {
+            auto other = Resources{};
+            other.set_resource<int>(4);
+            system.run(other, w);
+            expect(seen == 4);
+        };
+
+        should("re-resolve a new Resources at the same address") = [&] {
+            auto slot = std::optional<Resources>{};
+            slot.emplace().set_resource<int>(5);
+            system.run(*slot, w);
+            expect(seen == 5);
+
+            slot.reset();
+            slot.emplace().set_resource<int>(6);
+            system.run(*slot, w);
+            expect(seen == 6);
+        };
+
+        should("re-resolve a World replaced in place") = [&] {
+            auto count = 0;
+            auto count_ints_fn = [&count](Query<With<int const>> q) {
+                count = 0;
+                q.each([&count](int const) { ++count; });
+            };
+            auto count_ints = System::create(count_ints_fn);
+
+            auto world = World{};
+            world.emplace<int>(world.create(), 1);
+            count_ints.run(r, world);
+            expect(count == 1);
+
+            world = World{};
+            expect(find_world_id(world) == 0u);
+            count_ints.run(r, world);
+            expect(count == 0);
+            expect(find_world_id(world) != 0u);
+        };
+    };
+
     "[Commands]"_test = [] {
         auto r = Resources{};
         auto w = World{};
@@ -126,4 +268,78 @@ void system_test()
         expect((res.has_value()) >> fatal);
         expect(**res == 42);
     };
-}
\ No newline at end of file
+
+    "[Commands]: Deferred Until End Of Stage"_test = [] {
+        auto r = Resources{};
+        auto w = World{};
+        auto scheduler = Scheduler{};
+
+        struct StageA {};
+        struct StageB {};
+        scheduler.add_stage<StageA>();
+        scheduler.add_stage<StageB>();
+
+        std::size_t seen_in_stage_a = 99;
+        std::size_t seen_in_stage_b = 99;
+
+        auto spawn_entities = [](Commands cmds) {
+            for (int i = 0; i < 1000; ++i) {
+                cmds.spawn().add_component<int>(i);
+            }
+        };
+        auto count = [](Query<With<int const>>& q) {
+            std::size_t n = 0;
+            for (auto const e : q) {
+                UNUSED(e);
+                ++n;
+            }
+            return n;
+        };
+        auto count_in_stage_a = [&](Query<With<int const>> q) { seen_in_stage_a = count(q); };
+        auto count_in_stage_b = [&](Query<With<int const>> q) { seen_in_stage_b = count(q); };
+
+        scheduler.add_system_to_stage<StageA>(spawn_entities);
+        scheduler.add_system_to_stage<StageA>(count_in_stage_a);
+        scheduler.add_system_to_stage<StageB>(count_in_stage_b);
+        scheduler.run_stages(r, w);
+
+        expect(seen_in_stage_a == 0);
+        expect(seen_in_stage_b == 1000);
+        expect(w.view<int>().size() == 1000);
+    };
+
+    "[Commands]: Spawn Batch"_test = [] {
+        using namespace system_test_bundles;
+
+        auto r = Resources{};
+        auto w = World{};
+        auto scheduler = Scheduler{};
+
+        struct StageT {};
+        scheduler.add_stage<StageT>();
+
+        auto spawn_bundles = [](Commands cmds) {
+            auto batched = std::vector<BatchedBundle>{};
+            for (int i = 0; i < 100; ++i) {
+                batched.push_back(BatchedBundle{ .position = { i }, .tagged = i % 2 == 0 });
+            }
+            cmds.spawn_batch(MOV(batched));
+
+            auto const plain = std::vector{ PlainBundle{ 1 }, PlainBundle{ 2 } };
+            cmds.spawn_batch(plain);
+        };
+
+        scheduler.add_system_to_stage<StageT>(spawn_bundles);
+        scheduler.run_stages(r, w);
+
+        expect(BatchedBundle::batches == 1);
+        expect(w.size() == 102);
+        expect(w.view<Position>().size() == 100);
+        expect(w.view<Tag>().size() == 50);
+        expect(w.view<int>().size() == 2);
+
+        int sum = 0;
+        w.view<Position>().each([&sum](Position const& p) { sum += p.x; });
+        expect(sum == 4950);
+    };
+}
@@ -65,4 +65,111 @@ void events_test()
 
         expect(get_events(events, reader_missed) == std::vector{ event2 });
     };
-}
\ No newline at end of file
+
+    "[Events] buffers keep capacity across updates"_test = [] {
+        auto events = Events<int>();
+
+        for (auto i = 0; i < 64; ++i) {
+            events.send(i);
+        }
+        events.update();
+        events.update();
+
+        expect(events.is_empty());
+        expect(events.capacity() >= 64u);
+
+        auto const capacity = events.capacity();
+        auto reader = events.get_reader_current();
+        for (auto i = 0; i < 64; ++i) {
+            events.send(i);
+        }
+
+        expect(events.capacity() == capacity);
+        expect(get_events(events, reader).size() == 64u);
+    };
+
+    "[Events] shrink after quiet updates"_test = [] {
+        auto events = Events<int>();
+        events.set_shrink_after_quiet_updates(2);
+
+        events.send(0);
+        events.update();
+        events.send(1);
+        events.update();
+        events.update();
+
+        expect(events.capacity() > 0u);
+
+        events.update();
+
+        expect(events.capacity() == 0u);
+
+        auto reader = events.get_reader();
+        events.send(2);
+        expect(get_events(events, reader) == std::vector{ 2 });
+    };
+
+    "[Events] send_batch"_test = [] {
+        auto events = Events<int>();
+        auto reader = events.get_reader();
+
+        auto const values = std::vector{ 1, 2, 3, 4 };
+        events.send_batch(values.begin(), values.end());
+        events.send(5);
+
+        expect(get_events(events, reader) == std::vector{ 1, 2, 3, 4, 5 });
+
+        auto ids = std::vector<std::size_t>{};
+        auto id_reader = events.get_reader();
+        for (auto const& [id, value] : id_reader.iter_with_id(events)) {
+            ids.push_back(id.id);
+        }
+        expect(ids == std::vector<std::size_t>{ 0, 1, 2, 3, 4 });
+    };
+
+    "[Events] spans"_test = [] {
+        auto events = Events<int>();
+        auto reader = events.get_reader();
+        auto batch_reader = events.get_reader();
+
+        auto const flatten = [](EventSpans<int> const& spans) {
+            auto vec = std::vector<int>{};
+            for (auto const span : spans) {
+                for (auto const& event : span) {
+                    vec.push_back(event.value);
+                }
+            }
+            return vec;
+        };
+
+        events.send(0);
+        events.send(1);
+        events.update();
+        events.send(2);
+
+        auto spans = reader.spans(events);
+        expect(spans[0].size() == 2u);
+        expect(spans[1].size() == 1u);
+        expect(flatten(spans) == std::vector{ 0, 1, 2 });
+        expect(flatten(reader.spans(events)).empty());
+
+        events.send(3);
+        events.update();
+        events.send(4);
+
+        expect(flatten(reader.spans(events)) == std::vector{ 3, 4 });
+
+        auto batches = std::size_t{ 0 };
+        auto sum = 0;
+        batch_reader.for_each_batch(events, [&](std::span<Event<int> const> const batch) {
+            ++batches;
+            for (auto const& event : batch) {
+                sum += event.value;
+            }
+        });
+
+        // events 0 and 1 were dropped by the second update.
+        expect(batches == 2u);
+        expect(sum == 2 + 3 + 4);
+    };
+}
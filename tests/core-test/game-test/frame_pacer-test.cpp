@@ -0,0 +1,40 @@
+#include <chrono>
+#include <ut.hpp>
+#include <core/game/frame_pacer.hpp>
+
+using namespace boost::ut;
+using namespace std::chrono_literals;
+
+void frame_pacer_test()
+{
+    "[FrameStats]"_test = [] {
+        auto stats = FrameStats{};
+        expect(stats.mean() == FrameStats::dur_t::zero());
+
+        stats.record(10ms, false);
+        stats.record(20ms, true);
+        stats.record(30ms, false);
+
+        expect(stats.frames() == 3);
+        expect(stats.missed_deadlines() == 1);
+        expect(std::abs(stats.mean().count() - 0.020) < 1e-9);
+        expect(std::abs(stats.stddev().count() - 0.0081650) < 1e-6);
+
+        for (std::size_t i = 0; i < FrameStats::window; ++i) {
+            stats.record(5ms, false);
+        }
+        expect(std::abs(stats.mean().count() - 0.005) < 1e-9) << "only the most recent frames are kept";
+        expect(stats.stddev().count() < 1e-6);
+    };
+
+    "[FramePacer]"_test = [] {
+        auto pacer = FramePacer{};
+        for (int i = 0; i < 5; ++i) {
+            auto const deadline = FramePacer::clock_t::now() + 3ms;
+            pacer.wait_until(deadline);
+            expect(FramePacer::clock_t::now() >= deadline);
+        }
+        expect(pacer.spin_threshold() >= FramePacer::min_spin_threshold);
+        expect(pacer.spin_threshold() <= FramePacer::max_spin_threshold);
+    };
+}
@@ -0,0 +1,135 @@
+#include <core/game/game.hpp>
+#include <core/game/parallel_events.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace parallel_events_test_ns {
+
+    auto read_all(Events<int> const& events)
+    {
+        auto reader = events.get_reader();
+        auto vec = std::vector<int>{};
+        for (auto const& value : reader.iter(events)) {
+            vec.push_back(value);
+        }
+        return vec;
+    }
+
+    void writer_a(ParallelEventWriter<int> writer)
+    {
+        writer.send(1);
+        writer.send(2);
+    }
+
+    void writer_b(ParallelEventWriter<int> writer)
+    {
+        auto const values = std::vector{ 10, 20 };
+        writer.send_batch(values.begin(), values.end());
+    }
+
+    void task_writer(ParallelEventWriter<int> writer, Resource<TaskPool const> pool)
+    {
+        pool->scope([&writer](TaskPool::Scope& scope) {
+            for (auto task = 0; task < 8; ++task) {
+                scope.spawn([writer] {
+                    for (auto i = 0; i < 100; ++i) {
+                        writer.send(1000);
+                    }
+                });
+            }
+        });
+    }
+
+} // namespace parallel_events_test_ns
+
+#include <ut.hpp>
+using namespace boost::ut;
+
+void parallel_events_test()
+{
+    using namespace parallel_events_test_ns;
+
+    "[ParallelEvents] flush in lane order"_test = [] {
+        auto parallel = ParallelEvents<int>();
+        auto events = Events<int>();
+
+        auto late = parallel.writer(2);
+        auto early = parallel.writer(1);
+
+        late.send(3);
+        early.send(1);
+        late.send(4);
+        early.send(2);
+
+        expect(parallel.len() == 4u);
+
+        parallel.flush(events);
+
+        expect(parallel.len() == 0u);
+        expect(read_all(events) == std::vector{ 1, 2, 3, 4 });
+
+        // the same key maps to the same lane.
+        expect(&parallel.lane(1) == &parallel.lane(1));
+    };
+
+    "[ParallelEvents] send from many threads"_test = [] {
+        auto parallel = ParallelEvents<int>();
+        auto events = Events<int>();
+
+        constexpr auto thread_count = 8;
+        constexpr auto per_thread = 1000;
+
+        auto shared = parallel.writer(thread_count);
+        auto threads = std::vector<std::thread>{};
+        for (auto t = 0; t < thread_count; ++t) {
+            threads.emplace_back([own = parallel.writer(t), shared, t] {
+                for (auto i = 0; i < per_thread; ++i) {
+                    own.send(t * per_thread + i);
+                    shared.send(-1);
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        parallel.flush(events);
+        auto const values = read_all(events);
+
+        expect(values.size() == static_cast<std::size_t>(2 * thread_count * per_thread));
+
+        // lanes with a single producer keep their order, and come before the shared lane.
+        auto in_order = true;
+        for (auto i = 0; i < thread_count * per_thread; ++i) {
+            in_order &= values[static_cast<std::size_t>(i)] == i;
+        }
+        expect(in_order);
+        expect(std::all_of(values.begin() + thread_count * per_thread, values.end(), [](int const v) { return v == -1; }));
+    };
+
+    "[ParallelEvents] merged at the events stage"_test = [] {
+        auto builder = GameBuilder();
+        builder.add_parallel_event<int>()
+            .add_system(writer_a)
+            .add_system(writer_b)
+            .add_system(task_writer);
+
+        auto game = MOV(builder).build();
+        game.update();
+
+        auto const events = game.resources.get_resource<Events<int> const>();
+        expect(events.has_value());
+        auto values = read_all(**events);
+
+        // nothing has been flushed yet, `Update` runs after `CoreStages::Events`.
+        expect(values.empty());
+
+        game.update();
+        values = read_all(**events);
+
+        expect(values.size() == 804u);
+        expect(std::vector(values.begin(), values.begin() + 4) == std::vector{ 1, 2, 10, 20 });
+        expect(std::all_of(values.begin() + 4, values.end(), [](int const v) { return v == 1000; }));
+    };
+}
@@ -1,4 +1,5 @@
 #include "ut.hpp"
+#include <core/game/headless_plugins.hpp>
 #include <core/game/runner.hpp>
 
 using namespace boost::ut;
@@ -8,14 +9,43 @@ void game_exit_system(Resource<Events<GameExit>> game_exit_events)
     game_exit_events->send(GameExit{});
 }
 
+namespace runner_test_ns {
+
+    int ticks = 0;
+
+    void exit_after_ticks_system(Resource<Events<GameExit>> game_exit_events)
+    {
+        if (++ticks == 100) {
+            game_exit_events->send(GameExit{});
+        }
+    }
+
+} // namespace runner_test_ns
+
 void runner_test()
 {
-    auto builder = GameBuilder();
-    builder.add_plugin(SchedulerRunnerPlugin{});
-    builder.add_system(game_exit_system);
+    {
+        auto builder = GameBuilder();
+        builder.add_plugin(SchedulerRunnerPlugin{});
+        builder.add_system(game_exit_system);
 
-    auto game = MOV(builder).build();
-    game.run();
+        auto game = MOV(builder).build();
+        game.run();
 
-    expect(true); // .run() should not infinite loop
-}
\ No newline at end of file
+        expect(true); // .run() should not infinite loop
+    }
+
+    {
+        auto builder = GameBuilder();
+        builder.add_plugin(HeadlessPlugins{ .tick_rate = tl::nullopt });
+        builder.add_system(runner_test_ns::exit_after_ticks_system);
+
+        auto game = MOV(builder).build();
+        game.run();
+
+        expect(runner_test_ns::ticks == 100);
+        expect(game.resources.contains_resource<Time>());
+        expect(game.resources.contains_resource<AssetServer>());
+        expect((*game.resources.get_resource<FrameStats>())->frames() == 99) << "headless games run unpaced, in a loop";
+    }
+}
@@ -1,4 +1,5 @@
 #include <ut.hpp>
+#include <core/game/event_coalescing.hpp>
 #include <core/input/mouse.hpp>
 
 using namespace boost::ut;
@@ -19,4 +20,40 @@ void mouse_test()
         expect(middle != other_1 && middle != other_2);
         expect(other_1 != other_2);
     };
-}
\ No newline at end of file
+
+    "[MouseMotion] coalescing"_test = [] {
+        auto resources = Resources();
+        resources.try_add_resource<Events<MouseMotion>>();
+
+        auto const send_motions = [&resources] {
+            auto writer = CoalescingEventWriter<MouseMotion>::create(resources);
+            for (std::uint32_t i = 1; i <= 4; ++i) {
+                writer.send(MouseMotion{ .delta = Vec2(1.f, 2.f), .first_timestamp = i, .last_timestamp = i });
+            }
+            return writer.is_coalescing();
+        };
+
+        auto const read_motions = [&resources] {
+            auto events = resources.get_resource<Events<MouseMotion> const>();
+            auto reader = (**events).get_reader();
+            auto motions = std::vector<MouseMotion>{};
+            for (auto const& motion : reader.iter(**events)) {
+                motions.push_back(motion);
+            }
+            (**resources.get_resource<Events<MouseMotion>>()).clear();
+            return motions;
+        };
+
+        expect(!send_motions());
+        expect(read_motions().size() == 4u);
+
+        resources.try_add_resource<CoalesceEvents<MouseMotion>>();
+
+        expect(send_motions());
+        auto const motions = read_motions();
+        expect(motions.size() == 1u);
+        expect(motions[0].delta == Vec2(4.f, 8.f));
+        expect(motions[0].first_timestamp == 1u);
+        expect(motions[0].last_timestamp == 4u);
+    };
+}
@@ -0,0 +1,149 @@
+#include <ut.hpp>
+#include <core/task/task_pool.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace boost::ut;
+
+void task_pool_test()
+{
+    "[TaskPool]"_test = [] {
+        auto pool = TaskPool(4);
+        expect(pool.thread_count() == 4);
+
+        should("return spawned results") = [&] {
+            auto tasks = std::vector<Task<int>>{};
+            for (int i = 0; i < 100; ++i) {
+                tasks.push_back(pool.spawn([i] { return i * 2; }));
+            }
+
+            int sum = 0;
+            for (auto& task : tasks) {
+                sum += task.get();
+            }
+            expect(sum == 9900);
+        };
+
+        should("accept move only jobs") = [&] {
+            auto task = pool.spawn([value = std::make_unique<int>(42)] { return *value; });
+            expect(task.get() == 42);
+        };
+
+        should("wait on void tasks") = [&] {
+            std::atomic<int> count{ 0 };
+            auto task = pool.spawn([&count] { ++count; });
+            task.wait();
+            expect(task.is_ready());
+            expect(count == 1);
+        };
+
+        should("join every task spawned in a scope") = [&] {
+            std::atomic<int> count{ 0 };
+            pool.scope([&](TaskPool::Scope& scope) {
+                for (int i = 0; i < 1000; ++i) {
+                    scope.spawn([&count] { ++count; });
+                }
+            });
+            expect(count == 1000);
+        };
+
+        should("support nested scopes") = [&] {
+            std::atomic<int> count{ 0 };
+            pool.scope([&](TaskPool::Scope& outer) {
+                for (int i = 0; i < 16; ++i) {
+                    outer.spawn([&] {
+                        pool.scope([&](TaskPool::Scope& inner) {
+                            for (int j = 0; j < 16; ++j) {
+                                inner.spawn([&count] { ++count; });
+                            }
+                        });
+                    });
+                }
+            });
+            expect(count == 256);
+        };
+
+        should("leave executed jobs to the workers") = [&] {
+            auto single = TaskPool(1);
+            std::atomic<bool> release{ false };
+            std::atomic<bool> ran{ false };
+            single.execute([&release] { release.wait(false); });
+            single.execute([&ran] { ran = true; ran.notify_all(); });
+
+            // the only worker is blocked, so the scope's jobs run on this thread.
+            std::atomic<int> count{ 0 };
+            single.scope([&](TaskPool::Scope& scope) {
+                for (int i = 0; i < 16; ++i) {
+                    scope.spawn([&count] { ++count; });
+                }
+            });
+            expect(count == 16);
+            expect(!ran);
+
+            release = true;
+            release.notify_all();
+            ran.wait(false);
+            expect(ran.load());
+        };
+
+        should("wake a sleeping scope for a task spawned while it sleeps") = [&] {
+            auto single = TaskPool(1);
+            std::atomic<bool> started{ false };
+            std::atomic<bool> release{ false };
+            std::atomic<bool> nested_ran{ false };
+
+            auto releaser = std::thread([&release] {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                release = true;
+                release.notify_all();
+            });
+
+            // the only worker blocks until the nested task has run, which leaves it to the thread joining the scope.
+            single.scope([&](TaskPool::Scope& scope) {
+                scope.spawn([&] {
+                    started = true;
+                    started.notify_all();
+                    release.wait(false);
+                    scope.spawn([&nested_ran] {
+                        nested_ran = true;
+                        nested_ran.notify_all();
+                    });
+                    nested_ran.wait(false);
+                });
+                started.wait(false);
+            });
+            releaser.join();
+            expect(nested_ran.load());
+        };
+    };
+
+    "[TaskPool] dropped by its own job"_test = [] {
+        struct Signal
+        {
+            std::shared_ptr<std::atomic<bool>> done;
+            ~Signal()
+            {
+                done->store(true);
+                done->notify_all();
+            }
+        };
+        // members are destroyed in reverse, so `done` is only set once the pool is gone.
+        struct Owner
+        {
+            Signal signal;
+            TaskPool pool;
+        };
+
+        auto const done = std::make_shared<std::atomic<bool>>(false);
+        {
+            auto pool = TaskPool(2);
+            auto owner = std::shared_ptr<Owner>(new Owner{ Signal{ done }, pool });
+            pool.execute([owner = MOV(owner)] {});
+        }
+        done->wait(false);
+        expect(done->load());
+    };
+}
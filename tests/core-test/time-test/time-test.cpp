@@ -0,0 +1,89 @@
+#include <chrono>
+#include <ut.hpp>
+#include <core/ecs/resource.hpp>
+#include <core/ecs/scheduler.hpp>
+#include <core/ecs/world.hpp>
+#include <core/time/fixed_timestep.hpp>
+#include <core/time/time.hpp>
+
+using namespace boost::ut;
+using namespace std::chrono_literals;
+
+namespace time_test_stages {
+
+    struct Fixed {};
+
+} // namespace time_test_stages
+
+void time_test()
+{
+    "[Time]"_test = [] {
+        auto time = Time{};
+        time.update_with_instant(time.startup() + 10ms);
+        expect(time.delta() == Time::duration_t::zero());
+        expect(time.frame_count() == 1);
+
+        time.update_with_instant(time.startup() + 26ms);
+        expect(time.delta() == 16ms);
+        expect(time.elapsed() == 26ms);
+        expect(time.frame_count() == 2);
+    };
+
+    "[FixedTime]"_test = [] {
+        should("run a step for every step of accumulated time") = [] {
+            auto fixed = FixedTime(10ms, 5);
+            expect(fixed.accumulate(5ms) == 0);
+            expect(fixed.alpha() == 0.5f);
+            expect(fixed.accumulate(17ms) == 2);
+            expect(fixed.accumulated() == 2ms);
+            expect(fixed.dropped_steps() == 0);
+        };
+
+        should("drop steps past the max steps") = [] {
+            auto fixed = FixedTime(10ms, 3);
+            expect(fixed.accumulate(104ms) == 3);
+            expect(fixed.accumulated() == 4ms);
+            expect(fixed.dropped_steps() == 7);
+        };
+
+        should("convert a tick rate to a step") = [] {
+            expect(FixedTime::from_hz(100.0).step() == 10ms);
+        };
+    };
+
+    "[FixedTimestepStage]"_test = [] {
+        auto r = Resources{};
+        r.set_resource<Time>();
+        r.set_resource<FixedTime>(10ms, 4);
+        auto w = World{};
+
+        int runs = 0;
+        auto fixed_system = [&runs](Resource<FixedTime const> fixed) {
+            ++runs;
+            expect(fixed->elapsed() == 10ms * fixed->step_count());
+        };
+
+        auto scheduler = Scheduler{};
+        scheduler.add_stage<time_test_stages::Fixed, FixedTimestepStage>();
+        scheduler.add_system_to_stage<time_test_stages::Fixed>(fixed_system);
+
+        auto const frame = [&](Time::duration_t const at) {
+            (*r.get_resource<Time>())->update_with_instant((*r.get_resource<Time>())->startup() + at);
+            scheduler.run_stages(r, w);
+        };
+
+        frame(0ms);
+        expect(runs == 0);
+
+        frame(25ms);
+        expect(runs == 2);
+        expect((*r.get_resource<FixedTime>())->alpha() == 0.5f);
+
+        frame(30ms);
+        expect(runs == 3);
+
+        frame(130ms);
+        expect(runs == 7) << "catching up is limited to the max steps";
+        expect((*r.get_resource<FixedTime>())->dropped_steps() == 6);
+    };
+}
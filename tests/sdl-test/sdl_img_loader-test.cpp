@@ -33,6 +33,23 @@ void sdl_img_loader_test()
             auto const png = loader.load(path, *bytes);
             expect((png.has_value()) >> fatal);
             expect(png->type_id() == type_id<Texture>());
+
+            should("round trip through the asset cache") = [&] {
+                auto cached = std::vector<std::byte>{};
+                expect((loader.write_cache(*png, cached)) >> fatal);
+
+                auto const reloaded = loader.load_cached(path, cached);
+                expect((reloaded.has_value()) >> fatal);
+
+                auto const* const original = png->get<Texture>()->m_surface;
+                auto const* const surface = reloaded->get<Texture>()->m_surface;
+                expect(surface->w == original->w);
+                expect(surface->h == original->h);
+                expect(surface->format->format == SDL_IMG_Loader::cached_format);
+
+                // truncated entries are rejected rather than read past their end.
+                expect(!loader.load_cached(path, std::span(cached).first(cached.size() - 1)).has_value());
+            };
         };
     };
 }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include <fmt/format.h>
+
+#include <core/assets/asset_io/asset_pack.hpp>
+
+// usage: asset_pack <asset folder> <output pack>
+int main(int argc, char** argv)
+{
+	if (argc != 3) {
+		fmt::print(stderr, "usage: {} <asset folder> <output pack>\n", argc > 0 ? argv[0] : "asset_pack");
+		return 1;
+	}
+
+	auto const packed = write_asset_pack(argv[1], argv[2]);
+	if (!packed) {
+		fmt::print(stderr, "failed to pack '{}' into '{}': {}\n", argv[1], argv[2], packed.error().message());
+		return 1;
+	}
+
+	fmt::print("packed {} files from '{}' into '{}'\n", *packed, argv[1], argv[2]);
+	return 0;
+}